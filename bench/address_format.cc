@@ -0,0 +1,137 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+// Compare the cost of formatting addresses and 5-tuples by means of
+// std::ostream with the cost of the direct-to-buffer formatters.
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "holmes/net/ethernet/address.h"
+#include "holmes/net/inet/five_tuple.h"
+#include "holmes/net/inet4/address_value.h"
+#include "holmes/net/inet6/address_value.h"
+
+using namespace holmes;
+using namespace holmes::net;
+
+/** The number of distinct values to format. */
+const size_t count = 1024;
+
+/** The number of passes through the values. */
+const size_t passes = 1000;
+
+/** Measure and report the time taken to format a set of values.
+ * @param name the name of the benchmark
+ * @param fn a function to format the value at a given index, returning
+ *  the length of the result
+ */
+void run(const std::string& name, const std::function<size_t(size_t)>& fn) {
+	size_t total = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t pass = 0; pass != passes; ++pass) {
+		for (size_t i = 0; i != count; ++i) {
+			total += fn(i);
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+	double ns = std::chrono::duration<double, std::nano>(end - start).count();
+	std::cout << name << ": " << ns / (count * passes) << " ns/op"
+		<< " (" << total / (count * passes) << " chars)" << std::endl;
+}
+
+/** Format a value using std::ostream.
+ * @param value the value to be formatted
+ * @return the length of the result
+ */
+template<class T>
+size_t stream_format(const T& value) {
+	std::ostringstream out;
+	out << value;
+	return out.str().length();
+}
+
+/** Format a value using std::string conversion.
+ * @param value the value to be formatted
+ * @return the length of the result
+ */
+template<class T>
+size_t string_format(const T& value) {
+	return std::string(value).length();
+}
+
+/** Format a value into a fixed buffer using to_chars.
+ * @param value the value to be formatted
+ * @return the length of the result
+ */
+template<class T>
+size_t buffer_format(const T& value) {
+	char buffer[T::max_chars];
+	return to_chars(buffer, buffer + T::max_chars, value).ptr - buffer;
+}
+
+int main() {
+	std::vector<inet4::address_value> inet4_addrs;
+	std::vector<inet6::address_value> inet6_addrs;
+	std::vector<ethernet::address> ethernet_addrs;
+	std::vector<inet::five_tuple> tuples;
+
+	uint32_t seed = 1;
+	for (size_t i = 0; i != count; ++i) {
+		unsigned char octets[16];
+		for (unsigned char& octet : octets) {
+			seed = seed * 1103515245 + 12345;
+			octet = seed >> 16;
+		}
+		if (i % 4 == 0) {
+			octets[4] = octets[5] = octets[6] = octets[7] = 0;
+		}
+		octet::string raw(octets, 6);
+		inet4_addrs.emplace_back(octets);
+		inet6_addrs.emplace_back(octets);
+		ethernet_addrs.emplace_back(raw);
+		tuples.emplace_back(6, inet4_addrs.back(), 80,
+			inet4::address_value(octets + 4), 32768 + i);
+	}
+
+	run("inet4 ostream", [&](size_t i){
+		return stream_format(inet4_addrs[i]); });
+	run("inet4 string", [&](size_t i){
+		return string_format(inet4_addrs[i]); });
+	run("inet4 to_chars", [&](size_t i){
+		return buffer_format(inet4_addrs[i]); });
+
+	run("inet6 ostream", [&](size_t i){
+		return stream_format(inet6_addrs[i]); });
+	run("inet6 string", [&](size_t i){
+		return string_format(inet6_addrs[i]); });
+	run("inet6 to_chars", [&](size_t i){
+		return buffer_format(inet6_addrs[i]); });
+
+	run("ethernet ostream", [&](size_t i){
+		std::ostringstream out;
+		out << std::uppercase << ethernet_addrs[i];
+		return out.str().length(); });
+	run("ethernet string", [&](size_t i){
+		return string_format(ethernet_addrs[i]); });
+	run("ethernet to_chars", [&](size_t i){
+		return buffer_format(ethernet_addrs[i]); });
+
+	run("five_tuple ostream", [&](size_t i){
+		const inet::five_tuple& tuple = tuples[i];
+		std::ostringstream out;
+		out << int(tuple.protocol()) << ";"
+			<< tuple.src_addr() << ":" << tuple.src_port() << "=>"
+			<< tuple.dst_addr() << ":" << tuple.dst_port();
+		return out.str().length(); });
+	run("five_tuple string", [&](size_t i){
+		return string_format(tuples[i]); });
+	run("five_tuple to_chars", [&](size_t i){
+		return buffer_format(tuples[i]); });
+	return 0;
+}
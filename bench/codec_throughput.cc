@@ -0,0 +1,90 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+// Measure the throughput of the base64 and hex codecs at each level of
+// vector support available on this CPU.
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "holmes/octet/simd.h"
+#include "holmes/octet/base64/encoder.h"
+#include "holmes/octet/base64/decoder.h"
+#include "holmes/octet/hex/encoder.h"
+#include "holmes/octet/hex/decoder.h"
+
+using namespace holmes;
+
+/** The size of each binary input, in octets.
+ * This is typical of the payload of a full-sized Ethernet frame. */
+const size_t size = 1500;
+
+/** The number of times each operation is repeated. */
+const size_t repeats = 100000;
+
+/** Measure and report the throughput of an operation.
+ * Throughput is expressed in terms of binary octets, whichever direction
+ * the conversion is being performed in.
+ * @param name the name of the benchmark
+ * @param fn a function to perform the operation, returning the length
+ *  of the result
+ */
+void run(const std::string& name, const std::function<size_t()>& fn) {
+	size_t total = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i != repeats; ++i) {
+		total += fn();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double ns = std::chrono::duration<double, std::nano>(end - start).count();
+	std::cout << name << ": " << (size * repeats) / ns << " GB/s"
+		<< " (" << total / repeats << " chars)" << std::endl;
+}
+
+int main() {
+	std::mt19937 rng(0);
+	std::basic_string<unsigned char> raw(size, 0);
+	for (auto& b : raw) {
+		b = rng();
+	}
+	octet::string data(raw);
+	std::string base64 = octet::base64::encoder()(data, true);
+	std::string hex = octet::hex::encoder()(data);
+	std::string spaced_hex;
+	for (size_t i = 0; i != hex.length(); i += 2) {
+		spaced_hex += hex.substr(i, 2) + " ";
+	}
+
+	const std::pair<octet::simd_level, const char*> levels[] = {
+		{octet::simd_level::scalar, "scalar"},
+		{octet::simd_level::ssse3, "ssse3"},
+		{octet::simd_level::avx2, "avx2"}};
+	for (const auto& [level, level_name] : levels) {
+		octet::limit_simd(level);
+		if (octet::simd_support() != level) {
+			continue;
+		}
+		std::string suffix = std::string(" (") + level_name + ")";
+		run("base64 encode" + suffix, [&]() {
+			return octet::base64::encoder()(data, true).length();
+		});
+		run("base64 decode" + suffix, [&]() {
+			return octet::base64::decoder()(base64).length();
+		});
+		run("hex encode" + suffix, [&]() {
+			return octet::hex::encoder()(data).length();
+		});
+		run("hex decode" + suffix, [&]() {
+			return octet::hex::decoder()(hex).length();
+		});
+		run("hex decode spaced" + suffix, [&]() {
+			return octet::hex::decoder()(spaced_hex).length();
+		});
+	}
+	return 0;
+}
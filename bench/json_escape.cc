@@ -0,0 +1,66 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+// Measure the throughput of JSON string escaping for strings typical of
+// decoded packets, at each level of vector support available on this CPU.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "holmes/octet/simd.h"
+#include "holmes/bson/string.h"
+
+using namespace holmes;
+
+/** The number of times each string is escaped. */
+const size_t repeats = 1000000;
+
+/** Measure and report the time taken to escape a string.
+ * @param name the name of the benchmark
+ * @param value the string to be escaped
+ */
+void run(const std::string& name, const std::string& value) {
+	std::string result;
+	size_t total = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i != repeats; ++i) {
+		result.clear();
+		bson::append_json(result, value);
+		total += result.length();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double ns = std::chrono::duration<double, std::nano>(end - start).count();
+	std::cout << name << ": " << ns / repeats << " ns/string, "
+		<< (value.length() * repeats) / ns << " GB/s"
+		<< " (" << total / repeats << " chars)" << std::endl;
+}
+
+int main() {
+	const std::string address = "2001:db8:85a3::8a2e:370:7334";
+	const std::string option = "maximum_segment_size";
+	const std::string text(1000, 'x');
+	std::string escaped;
+	for (size_t i = 0; i != 100; ++i) {
+		escaped += "line \"nine\"\n";
+	}
+
+	const std::pair<octet::simd_level, const char*> levels[] = {
+		{octet::simd_level::scalar, "scalar"},
+		{octet::simd_level::ssse3, "ssse3"},
+		{octet::simd_level::avx2, "avx2"}};
+	for (const auto& [level, level_name] : levels) {
+		octet::limit_simd(level);
+		if (octet::simd_support() != level) {
+			continue;
+		}
+		std::string suffix = std::string(" (") + level_name + ")";
+		run("address" + suffix, address);
+		run("option name" + suffix, option);
+		run("plain text" + suffix, text);
+		run("escaped text" + suffix, escaped);
+	}
+	return 0;
+}
@@ -0,0 +1,158 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <stdexcept>
+#include <utility>
+
+#include "holmes/arrow/column.h"
+
+namespace holmes::arrow {
+
+/** Get the width of a fixed-width Arrow data type.
+ * @param type the data type
+ * @return the width in octets, or zero for booleans
+ */
+static size_t value_width(data_type type) {
+	switch (type) {
+	case data_type::uint8:
+		return 1;
+	case data_type::uint16:
+		return 2;
+	case data_type::uint32:
+	case data_type::utf8:
+		return 4;
+	case data_type::int64:
+	case data_type::timestamp:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+column::column(std::string name, data_type type):
+	_name(std::move(name)),
+	_type(type) {
+
+	clear();
+}
+
+void column::_put(uint64_t value, size_t size) {
+	size_t offset = _values.size();
+	_values.resize(offset + size);
+	for (size_t i = 0; i != size; ++i) {
+		_values[offset + i] = value >> (i * 8);
+	}
+}
+
+void column::_next(bool valid) {
+	size_t bit = _length % 8;
+	if (bit == 0) {
+		_validity.push_back(0);
+		if (_type == data_type::boolean) {
+			_values.push_back(0);
+		}
+	}
+	if (valid) {
+		_validity.back() |= 1 << bit;
+	} else {
+		_null_count += 1;
+	}
+	_length += 1;
+}
+
+void column::append_null() {
+	_next(false);
+	if (_type == data_type::utf8) {
+		_put(_chars.size(), 4);
+	} else if (_type != data_type::boolean) {
+		_put(0, value_width(_type));
+	}
+}
+
+void column::append(int64_t value) {
+	if (_type == data_type::utf8) {
+		throw std::invalid_argument("integer value in Arrow UTF-8 column");
+	}
+	size_t bit = _length % 8;
+	_next(true);
+	if (_type == data_type::boolean) {
+		if (value) {
+			_values.back() |= 1 << bit;
+		}
+	} else {
+		_put(value, value_width(_type));
+	}
+}
+
+void column::append(std::string_view value) {
+	if (_type != data_type::utf8) {
+		throw std::invalid_argument("string value in Arrow non-UTF-8 column");
+	}
+	_next(true);
+	_chars.insert(_chars.end(), value.begin(), value.end());
+	_put(_chars.size(), 4);
+}
+
+std::vector<column::buffer> column::buffers() const {
+	std::vector<buffer> result;
+	result.push_back(buffer{_validity.data(),
+		(_null_count) ? _validity.size() : 0});
+	result.push_back(buffer{_values.data(), _values.size()});
+	if (_type == data_type::utf8) {
+		result.push_back(buffer{_chars.data(), _chars.size()});
+	}
+	return result;
+}
+
+void column::truncate(size_t length) {
+	if (length > _length) {
+		throw std::invalid_argument("cannot extend Arrow column by truncation");
+	}
+
+	// Count the nulls among the values to be removed.
+	for (size_t i = length; i != _length; ++i) {
+		if (!(_validity[i / 8] & (1 << (i % 8)))) {
+			_null_count -= 1;
+		}
+	}
+
+	// Remove whole octets from the bitmaps, then clear any bits
+	// beyond the new length within the last octet.
+	size_t octets = (length + 7) / 8;
+	unsigned char mask = (1 << (length % 8)) - 1;
+	_validity.resize(octets);
+	if (mask) {
+		_validity.back() &= mask;
+	}
+	if (_type == data_type::boolean) {
+		_values.resize(octets);
+		if (mask) {
+			_values.back() &= mask;
+		}
+	} else if (_type == data_type::utf8) {
+		_values.resize((length + 1) * 4);
+		size_t chars = 0;
+		for (size_t i = 0; i != 4; ++i) {
+			chars |= size_t(_values[length * 4 + i]) << (i * 8);
+		}
+		_chars.resize(chars);
+	} else {
+		_values.resize(length * value_width(_type));
+	}
+	_length = length;
+}
+
+void column::clear() {
+	_length = 0;
+	_null_count = 0;
+	_validity.clear();
+	_values.clear();
+	_chars.clear();
+	if (_type == data_type::utf8) {
+		_put(0, 4);
+	}
+}
+
+} /* namespace holmes::arrow */
@@ -0,0 +1,155 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_ARROW_COLUMN
+#define HOLMES_ARROW_COLUMN
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace holmes::arrow {
+
+/** An enumeration of the supported Arrow data types. */
+enum class data_type {
+	/** A boolean, stored as one bit per value. */
+	boolean,
+	/** An unsigned 8-bit integer. */
+	uint8,
+	/** An unsigned 16-bit integer. */
+	uint16,
+	/** An unsigned 32-bit integer. */
+	uint32,
+	/** A signed 64-bit integer. */
+	int64,
+	/** A UTF-8 character string. */
+	utf8,
+	/** A timestamp in microseconds since the epoch, UTC. */
+	timestamp
+};
+
+/** A class to accumulate the values of one column of an Arrow record batch.
+ * Values are held in the Arrow in-memory format, so that the buffers can
+ * be written out as they stand: a validity bitmap, followed by either
+ * little-endian fixed-width values, or 32-bit offsets and character data
+ * for UTF-8 strings.
+ */
+class column {
+public:
+	/** A structure to refer to one of the buffers of a column. */
+	struct buffer {
+		/** A pointer to the content of the buffer. */
+		const unsigned char* data;
+
+		/** The length of the buffer, in octets. */
+		size_t length;
+	};
+private:
+	/** The name of this column. */
+	std::string _name;
+
+	/** The type of this column. */
+	data_type _type;
+
+	/** The number of values in this column. */
+	size_t _length = 0;
+
+	/** The number of those values which are null. */
+	size_t _null_count = 0;
+
+	/** The validity bitmap, with one bit set for each non-null value. */
+	std::vector<unsigned char> _validity;
+
+	/** The fixed-width values, bit-packed booleans, or string offsets. */
+	std::vector<unsigned char> _values;
+
+	/** The character data, for a UTF-8 column. */
+	std::vector<unsigned char> _chars;
+
+	/** Append a little-endian integer to the values buffer.
+	 * @param value the value to be appended
+	 * @param size the size of the value, in octets
+	 */
+	void _put(uint64_t value, size_t size);
+
+	/** Begin a new value, extending the bitmaps as needed.
+	 * @param valid true if the value is non-null, otherwise false
+	 */
+	void _next(bool valid);
+public:
+	/** Construct empty column.
+	 * @param name the name of the column
+	 * @param type the type of the column
+	 */
+	column(std::string name, data_type type);
+
+	/** Get the name of this column.
+	 * @return the name
+	 */
+	const std::string& name() const {
+		return _name;
+	}
+
+	/** Get the type of this column.
+	 * @return the type
+	 */
+	data_type type() const {
+		return _type;
+	}
+
+	/** Get the number of values in this column.
+	 * @return the number of values
+	 */
+	size_t length() const {
+		return _length;
+	}
+
+	/** Get the number of null values in this column.
+	 * @return the number of null values
+	 */
+	size_t null_count() const {
+		return _null_count;
+	}
+
+	/** Append a null value. */
+	void append_null();
+
+	/** Append an integer, boolean or timestamp value.
+	 * Integers are truncated to the width of the column.
+	 * @param value the value to be appended
+	 * @throws std::invalid_argument if this is a UTF-8 column
+	 */
+	void append(int64_t value);
+
+	/** Append a character string value.
+	 * @param value the value to be appended
+	 * @throws std::invalid_argument if this is not a UTF-8 column
+	 */
+	void append(std::string_view value);
+
+	/** Get the buffers which make up this column, in Arrow order.
+	 * The validity bitmap is given a length of zero if there are no
+	 * nulls, which Arrow permits.
+	 * @return the buffers
+	 */
+	std::vector<buffer> buffers() const;
+
+	/** Remove all values beyond a given length.
+	 * This is intended for discarding a partially-appended row.
+	 * @param length the required number of values
+	 * @throws std::invalid_argument if that is greater than the
+	 *  current length
+	 */
+	void truncate(size_t length);
+
+	/** Remove all values, retaining the capacity of the buffers. */
+	void clear();
+};
+
+} /* namespace holmes::arrow */
+
+#endif
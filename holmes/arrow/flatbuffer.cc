@@ -0,0 +1,125 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <algorithm>
+
+#include "holmes/arrow/flatbuffer.h"
+
+namespace holmes::arrow {
+
+flatbuffer::flatbuffer() {
+	_put(0, 4);
+}
+
+void flatbuffer::_put(uint64_t value, size_t size) {
+	for (size_t i = 0; i != size; ++i) {
+		_data.push_back(value >> (i * 8));
+	}
+}
+
+void flatbuffer::align(size_t alignment) {
+	while (_data.size() % alignment) {
+		_data.push_back(0);
+	}
+}
+
+void flatbuffer::link(size_t at, size_t target) {
+	uint32_t offset = target - at;
+	for (size_t i = 0; i != 4; ++i) {
+		_data[at + i] = offset >> (i * 8);
+	}
+}
+
+flatbuffer::placement flatbuffer::table(const std::vector<field>& fields) {
+	// Lay out the fields in decreasing order of size, following the
+	// offset to the vtable, with each aligned to its size.
+	std::vector<size_t> order(fields.size());
+	for (size_t i = 0; i != order.size(); ++i) {
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(),
+		[&fields](size_t lhs, size_t rhs) {
+			return fields[lhs].size > fields[rhs].size;
+		});
+
+	std::vector<size_t> offsets(fields.size());
+	unsigned int id_count = 0;
+	size_t table_size = 4;
+	for (size_t i : order) {
+		const field& f = fields[i];
+		table_size = (table_size + f.size - 1) / f.size * f.size;
+		offsets[i] = table_size;
+		table_size += f.size;
+		id_count = std::max(id_count, f.id + 1);
+	}
+
+	// Write the vtable immediately before the table.
+	align(2);
+	size_t vtable_pos = _data.size();
+	std::vector<uint16_t> slots(id_count, 0);
+	for (size_t i = 0; i != fields.size(); ++i) {
+		slots[fields[i].id] = offsets[i];
+	}
+	_put(4 + id_count * 2, 2);
+	_put(table_size, 2);
+	for (uint16_t slot : slots) {
+		_put(slot, 2);
+	}
+
+	// Write the table.
+	align(8);
+	size_t table_pos = _data.size();
+	_put(table_pos - vtable_pos, 4);
+	_data.resize(table_pos + table_size, 0);
+	placement result{table_pos, std::vector<size_t>(fields.size())};
+	for (size_t i = 0; i != fields.size(); ++i) {
+		size_t pos = table_pos + offsets[i];
+		result.fields[i] = pos;
+		for (size_t j = 0; j != fields[i].size; ++j) {
+			_data[pos + j] = fields[i].value >> (j * 8);
+		}
+	}
+	return result;
+}
+
+flatbuffer::placement flatbuffer::root(const std::vector<field>& fields) {
+	placement result = table(fields);
+	link(0, result.start);
+	return result;
+}
+
+size_t flatbuffer::string(std::string_view value) {
+	align(4);
+	size_t pos = _data.size();
+	_put(value.length(), 4);
+	_data.insert(_data.end(), value.begin(), value.end());
+	_data.push_back(0);
+	return pos;
+}
+
+size_t flatbuffer::offsets(size_t count) {
+	align(4);
+	size_t pos = _data.size();
+	_put(count, 4);
+	_data.resize(_data.size() + count * 4, 0);
+	return pos;
+}
+
+size_t flatbuffer::pairs(const std::vector<int64_t>& values) {
+	// The elements must be aligned to 8 octets, so the length field
+	// must end on such a boundary.
+	align(4);
+	if (_data.size() % 8 == 0) {
+		_put(0, 4);
+	}
+	size_t pos = _data.size();
+	_put(values.size() / 2, 4);
+	for (int64_t value : values) {
+		_put(value, 8);
+	}
+	return pos;
+}
+
+} /* namespace holmes::arrow */
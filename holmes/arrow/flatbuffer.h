@@ -0,0 +1,134 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_ARROW_FLATBUFFER
+#define HOLMES_ARROW_FLATBUFFER
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace holmes::arrow {
+
+/** A class for encoding a FlatBuffers buffer from front to back.
+ * This implements only the subset of FlatBuffers needed for Arrow IPC
+ * metadata: tables of scalar and offset fields, strings, vectors of
+ * offsets and vectors of 16-octet structs.
+ *
+ * The usual FlatBuffers builder works from back to front, so that each
+ * object is complete before anything refers to it. This class works in
+ * the opposite direction, which is the natural order for a writer. Each
+ * reference is written as a placeholder and filled in by link() once
+ * the target has been written. Since targets are always written after
+ * the references to them, all offsets point forwards as required.
+ *
+ * Every value is aligned to its size relative to the start of the
+ * buffer, which must itself be aligned to 8 octets when read.
+ */
+class flatbuffer {
+public:
+	/** A structure to describe a scalar or offset field of a table. */
+	struct field {
+		/** The field index, as given by its position in the schema. */
+		unsigned int id;
+
+		/** The size of the field, in octets: 1, 2, 4 or 8. */
+		unsigned int size;
+
+		/** The value of the field, or zero for an offset. */
+		uint64_t value;
+	};
+
+	/** A structure to describe where a table has been written. */
+	struct placement {
+		/** The position of the table. */
+		size_t start;
+
+		/** The position of each field, in the order given. */
+		std::vector<size_t> fields;
+	};
+private:
+	/** The content of the buffer. */
+	std::vector<unsigned char> _data;
+
+	/** Append a little-endian integer.
+	 * @param value the value to be appended
+	 * @param size the size of the value, in octets
+	 */
+	void _put(uint64_t value, size_t size);
+public:
+	/** Construct empty buffer.
+	 * Space is reserved for the offset to the root table.
+	 */
+	flatbuffer();
+
+	/** Pad the buffer with zeros to a given alignment.
+	 * @param alignment the required alignment, in octets
+	 */
+	void align(size_t alignment);
+
+	/** Fill in an offset field so that it refers to a given position.
+	 * @param at the position of the offset field
+	 * @param target the position of the object referred to
+	 */
+	void link(size_t at, size_t target);
+
+	/** Write a table.
+	 * Fields are laid out in decreasing order of size to minimise
+	 * padding. The position of each field is returned so that offset
+	 * fields can be linked once their targets have been written.
+	 * @param fields the fields of the table, in any order
+	 * @return the position of the table and of each field
+	 */
+	placement table(const std::vector<field>& fields);
+
+	/** Write the root table.
+	 * This is the same as table(), except that the root offset at the
+	 * start of the buffer is linked to it.
+	 * @param fields the fields of the table, in any order
+	 * @return the position of the table and of each field
+	 */
+	placement root(const std::vector<field>& fields);
+
+	/** Write a string.
+	 * @param value the content of the string
+	 * @return the position of the string
+	 */
+	size_t string(std::string_view value);
+
+	/** Write a vector of offsets.
+	 * The offsets are initially zero, and must be linked to their targets.
+	 * @param count the number of elements
+	 * @return the position of the vector; the position of element i is
+	 *  this plus 4 * (i + 1)
+	 */
+	size_t offsets(size_t count);
+
+	/** Write a vector of structs each consisting of two 64-bit integers.
+	 * This is the layout of the Arrow FieldNode and Buffer structs.
+	 * @param values the integers, two per struct
+	 * @return the position of the vector
+	 */
+	size_t pairs(const std::vector<int64_t>& values);
+
+	/** Get the content of the buffer.
+	 * @return a pointer to the content
+	 */
+	const unsigned char* data() const {
+		return _data.data();
+	}
+
+	/** Get the size of the buffer.
+	 * @return the size, in octets
+	 */
+	size_t size() const {
+		return _data.size();
+	}
+};
+
+} /* namespace holmes::arrow */
+
+#endif
@@ -0,0 +1,126 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <algorithm>
+
+#include "holmes/arrow/row_emitter.h"
+
+namespace holmes::arrow {
+
+row_emitter::row_emitter(std::vector<column>& columns):
+	_columns(&columns) {}
+
+void row_emitter::map(const std::string& path, size_t index) {
+	_paths[path] = index;
+}
+
+std::vector<std::string> row_emitter::paths() const {
+	std::vector<std::string> result;
+	for (const auto& [path, index] : _paths) {
+		result.push_back(path);
+	}
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+column* row_emitter::_target() {
+	if (_array_depth) {
+		return nullptr;
+	}
+	auto f = _paths.find(_member);
+	if (f == _paths.end() || _filled[f->second]) {
+		return nullptr;
+	}
+	return &(*_columns)[f->second];
+}
+
+void row_emitter::_push() {
+	_stack.push_back(_path.length());
+	_path = _member;
+}
+
+void row_emitter::_pop() {
+	if (!_stack.empty()) {
+		_path.resize(_stack.back());
+		_stack.pop_back();
+	}
+}
+
+void row_emitter::_begin_document() {
+	if (!_in_row) {
+		_in_row = true;
+		_path.clear();
+		_member.clear();
+		_stack.clear();
+		_array_depth = 0;
+		_filled.assign(_columns->size(), false);
+		return;
+	}
+	_push();
+}
+
+void row_emitter::_end_document() {
+	if (!_stack.empty()) {
+		_pop();
+		return;
+	}
+	_in_row = false;
+	for (size_t i = 0; i != _columns->size(); ++i) {
+		if (!_filled[i]) {
+			(*_columns)[i].append_null();
+		}
+	}
+}
+
+void row_emitter::_begin_array() {
+	_array_depth += 1;
+	_push();
+}
+
+void row_emitter::_end_array() {
+	_array_depth -= 1;
+	_pop();
+}
+
+bool row_emitter::_key(std::string_view name) {
+	_member = _path;
+	if (!_member.empty()) {
+		_member.push_back('.');
+	}
+	_member.append(name);
+	return true;
+}
+
+void row_emitter::_null() {}
+
+void row_emitter::_boolean(bool value) {
+	_int64(value);
+}
+
+void row_emitter::_int32(int32_t value) {
+	_int64(value);
+}
+
+void row_emitter::_int64(int64_t value) {
+	if (column* col = _target()) {
+		if (col->type() != data_type::utf8) {
+			col->append(value);
+			_filled[col - _columns->data()] = true;
+		}
+	}
+}
+
+void row_emitter::_string(std::string_view value) {
+	if (column* col = _target()) {
+		if (col->type() == data_type::utf8) {
+			col->append(value);
+			_filled[col - _columns->data()] = true;
+		}
+	}
+}
+
+void row_emitter::_binary(const octet::string& value) {}
+
+} /* namespace holmes::arrow */
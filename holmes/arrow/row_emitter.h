@@ -0,0 +1,113 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_ARROW_ROW_EMITTER
+#define HOLMES_ARROW_ROW_EMITTER
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "holmes/bson/emitter.h"
+#include "holmes/arrow/column.h"
+
+namespace holmes::arrow {
+
+/** An emitter class for appending each document as a row of a set of
+ * Arrow columns.
+ * Each column is fed by one or more member paths, written as member
+ * names separated by dots in the same way as for bson::projection.
+ * Where several paths feed the same column, they are alternatives (for
+ * example inet4.ttl and inet6.hop_limit), and the first value to arrive
+ * is used. When the outermost document ends, any column which did not
+ * receive a value is given a null, so that every column has one entry
+ * per document.
+ *
+ * Values which are not of a suitable type for their column are ignored,
+ * as are members which do not correspond to a column and the content of
+ * arrays. To avoid computing unwanted members, this emitter is best
+ * placed behind a bson::projection which selects the mapped paths.
+ */
+class row_emitter:
+	public bson::emitter {
+private:
+	/** The columns to receive the values. */
+	std::vector<column>* _columns;
+
+	/** The column index for each mapped path. */
+	std::unordered_map<std::string, size_t> _paths;
+
+	/** A flag for each column, set once it has a value for this row. */
+	std::vector<bool> _filled;
+
+	/** The path of the current document. */
+	std::string _path;
+
+	/** The path of the most recently named member. */
+	std::string _member;
+
+	/** The length of the path before each open document or array began,
+	 * excluding the outermost document. */
+	std::vector<size_t> _stack;
+
+	/** The depth of nesting within arrays, or zero if none. */
+	size_t _array_depth = 0;
+
+	/** True if a row is in progress. */
+	bool _in_row = false;
+
+	/** Find the column for the current member, if it is still unfilled.
+	 * @return the column, or null if none
+	 */
+	column* _target();
+
+	/** Begin a nested document or array. */
+	void _push();
+
+	/** End a nested document or array. */
+	void _pop();
+protected:
+	void _begin_document() override;
+	void _end_document() override;
+	void _begin_array() override;
+	void _end_array() override;
+	bool _key(std::string_view name) override;
+	void _null() override;
+	void _boolean(bool value) override;
+	void _int32(int32_t value) override;
+	void _int64(int64_t value) override;
+	void _string(std::string_view value) override;
+	void _binary(const octet::string& value) override;
+public:
+	/** Construct row emitter.
+	 * @param columns the columns to receive the values
+	 */
+	explicit row_emitter(std::vector<column>& columns);
+
+	/** Map a member path to a column.
+	 * @param path the path of the member
+	 * @param index the index of the column
+	 */
+	void map(const std::string& path, size_t index);
+
+	/** Abandon any row which is in progress.
+	 * This does not remove any values which have already been appended
+	 * to the columns for that row: the caller is responsible for
+	 * truncating them.
+	 */
+	void reset() {
+		_in_row = false;
+	}
+
+	/** Get the mapped paths.
+	 * This is suitable for passing to bson::projection.
+	 * @return the paths
+	 */
+	std::vector<std::string> paths() const;
+};
+
+} /* namespace holmes::arrow */
+
+#endif
@@ -0,0 +1,183 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "holmes/arrow/flatbuffer.h"
+#include "holmes/arrow/stream_writer.h"
+
+namespace holmes::arrow {
+
+/** The Arrow metadata version (V5). */
+static const unsigned int metadata_version = 4;
+
+/** Arrow MessageHeader union type codes. */
+static const unsigned int header_schema = 1;
+static const unsigned int header_record_batch = 3;
+
+/** Arrow Type union type codes. */
+static const unsigned int type_int = 2;
+static const unsigned int type_utf8 = 5;
+static const unsigned int type_bool = 6;
+static const unsigned int type_timestamp = 10;
+
+/** The Arrow TimeUnit code for microseconds. */
+static const unsigned int unit_microsecond = 2;
+
+/** Zeros for padding output to an 8-octet boundary. */
+static const char padding[8] = {};
+
+/** Round a length up to a multiple of 8 octets.
+ * @param length the length to be rounded
+ * @return the rounded length
+ */
+static size_t pad8(size_t length) {
+	return (length + 7) & ~size_t(7);
+}
+
+/** Write the Type table for an Arrow data type.
+ * @param fb the buffer to receive the table
+ * @param type the data type
+ * @return the position of the table
+ */
+static size_t write_type(flatbuffer& fb, data_type type) {
+	switch (type) {
+	case data_type::boolean:
+		return fb.table({}).start;
+	case data_type::uint8:
+		return fb.table({{0, 4, 8}, {1, 1, 0}}).start;
+	case data_type::uint16:
+		return fb.table({{0, 4, 16}, {1, 1, 0}}).start;
+	case data_type::uint32:
+		return fb.table({{0, 4, 32}, {1, 1, 0}}).start;
+	case data_type::int64:
+		return fb.table({{0, 4, 64}, {1, 1, 1}}).start;
+	case data_type::utf8:
+		return fb.table({}).start;
+	case data_type::timestamp:
+		{
+			auto ts = fb.table({{0, 2, unit_microsecond}, {1, 4, 0}});
+			fb.link(ts.fields[1], fb.string("UTC"));
+			return ts.start;
+		}
+	default:
+		throw std::invalid_argument("unsupported Arrow data type");
+	}
+}
+
+/** Get the Type union code for an Arrow data type.
+ * @param type the data type
+ * @return the union code
+ */
+static unsigned int type_code(data_type type) {
+	switch (type) {
+	case data_type::boolean:
+		return type_bool;
+	case data_type::utf8:
+		return type_utf8;
+	case data_type::timestamp:
+		return type_timestamp;
+	default:
+		return type_int;
+	}
+}
+
+stream_writer::stream_writer(std::ostream& out,
+	const std::vector<column>& columns):
+	_out(&out) {
+
+	_write_schema(columns);
+}
+
+void stream_writer::_write_metadata(const flatbuffer& metadata) {
+	// Continuation marker, then the metadata length, which is padded so
+	// that the body which follows is aligned to 8 octets.
+	int32_t length = pad8(metadata.size());
+	unsigned char prefix[8] = {0xff, 0xff, 0xff, 0xff};
+	for (size_t i = 0; i != 4; ++i) {
+		prefix[4 + i] = length >> (i * 8);
+	}
+	_out->write(reinterpret_cast<const char*>(prefix), sizeof(prefix));
+	_out->write(reinterpret_cast<const char*>(metadata.data()),
+		metadata.size());
+	_out->write(padding, length - metadata.size());
+}
+
+void stream_writer::_write_schema(const std::vector<column>& columns) {
+	flatbuffer fb;
+	auto message = fb.root({
+		{0, 2, metadata_version},
+		{1, 1, header_schema},
+		{2, 4, 0},
+		{3, 8, 0}});
+	auto schema = fb.table({{1, 4, 0}});
+	fb.link(message.fields[2], schema.start);
+	size_t fields = fb.offsets(columns.size());
+	fb.link(schema.fields[0], fields);
+
+	for (size_t i = 0; i != columns.size(); ++i) {
+		const column& col = columns[i];
+		auto field = fb.table({
+			{0, 4, 0},
+			{1, 1, 1},
+			{2, 1, type_code(col.type())},
+			{3, 4, 0},
+			{5, 4, 0}});
+		fb.link(fields + 4 * (i + 1), field.start);
+		fb.link(field.fields[0], fb.string(col.name()));
+		fb.link(field.fields[3], write_type(fb, col.type()));
+		fb.link(field.fields[4], fb.offsets(0));
+	}
+	_write_metadata(fb);
+}
+
+void stream_writer::write(const std::vector<column>& columns) {
+	size_t length = (columns.empty()) ? 0 : columns.front().length();
+	std::vector<int64_t> nodes;
+	std::vector<int64_t> layout;
+	std::vector<column::buffer> buffers;
+	size_t body_length = 0;
+	for (const column& col : columns) {
+		if (col.length() != length) {
+			throw std::invalid_argument(
+				"inconsistent column lengths in Arrow record batch");
+		}
+		nodes.push_back(col.length());
+		nodes.push_back(col.null_count());
+		for (const column::buffer& buf : col.buffers()) {
+			layout.push_back(body_length);
+			layout.push_back(buf.length);
+			buffers.push_back(buf);
+			body_length += pad8(buf.length);
+		}
+	}
+
+	flatbuffer fb;
+	auto message = fb.root({
+		{0, 2, metadata_version},
+		{1, 1, header_record_batch},
+		{2, 4, 0},
+		{3, 8, body_length}});
+	auto batch = fb.table({{0, 8, length}, {1, 4, 0}, {2, 4, 0}});
+	fb.link(message.fields[2], batch.start);
+	fb.link(batch.fields[1], fb.pairs(nodes));
+	fb.link(batch.fields[2], fb.pairs(layout));
+	_write_metadata(fb);
+
+	for (const column::buffer& buf : buffers) {
+		_out->write(reinterpret_cast<const char*>(buf.data), buf.length);
+		_out->write(padding, pad8(buf.length) - buf.length);
+	}
+}
+
+void stream_writer::close() {
+	static const char eos[8] = {
+		'\xff', '\xff', '\xff', '\xff', 0, 0, 0, 0};
+	_out->write(eos, sizeof(eos));
+	_out->flush();
+}
+
+} /* namespace holmes::arrow */
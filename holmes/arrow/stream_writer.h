@@ -0,0 +1,64 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_ARROW_STREAM_WRITER
+#define HOLMES_ARROW_STREAM_WRITER
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#include "holmes/arrow/column.h"
+
+namespace holmes::arrow {
+
+class flatbuffer;
+
+/** A class for writing record batches in the Arrow IPC streaming format.
+ * The stream consists of a schema message, which is written on
+ * construction, followed by one message per record batch, followed by
+ * an end-of-stream marker which is written by close(). The schema is
+ * taken from the names and types of the columns, and every batch must
+ * have the same columns in the same order.
+ *
+ * Message metadata is encoded as FlatBuffers, using the subset which
+ * Arrow needs. The body of each record batch is written directly from
+ * the column buffers, which are already in the Arrow in-memory format.
+ */
+class stream_writer {
+private:
+	/** The stream to receive the output. */
+	std::ostream* _out;
+
+	/** Write a message.
+	 * @param metadata the encoded Message table
+	 */
+	void _write_metadata(const flatbuffer& metadata);
+
+	/** Write the schema message.
+	 * @param columns the columns from which to take the schema
+	 */
+	void _write_schema(const std::vector<column>& columns);
+public:
+	/** Construct stream writer, and write the schema.
+	 * @param out the stream to receive the output
+	 * @param columns the columns from which to take the schema
+	 */
+	stream_writer(std::ostream& out, const std::vector<column>& columns);
+
+	/** Write a record batch.
+	 * All columns must be of the same length.
+	 * @param columns the columns of the record batch
+	 * @throws std::invalid_argument if the column lengths differ
+	 */
+	void write(const std::vector<column>& columns);
+
+	/** Write the end-of-stream marker. */
+	void close();
+};
+
+} /* namespace holmes::arrow */
+
+#endif
@@ -3,6 +3,7 @@
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
+#include "holmes/bson/builder.h"
 #include "holmes/artefact.h"
 
 namespace holmes {
@@ -13,4 +14,14 @@ bool artefact::_validate(const validation_policy& policy,
 	return true;
 }
 
+void artefact::emit(bson::emitter& em) const {
+	to_bson().emit(em);
+}
+
+bson::document artefact::to_bson() const {
+	bson::builder builder;
+	emit(builder);
+	return builder.release();
+}
+
 } /* namespace holmes */
@@ -9,6 +9,7 @@
 #include "holmes/validation_policy.h"
 #include "holmes/feature/logger.h"
 #include "holmes/bson/document.h"
+#include "holmes/bson/emitter.h"
 
 namespace holmes {
 
@@ -27,10 +28,21 @@ public:
 		return _validate(policy, log);
 	}
 
+	/** Describe this artefact to a BSON emitter.
+	 * The description is emitted as a single document. The default
+	 * implementation emits the result of to_bson().
+	 * @param em the emitter to receive the description
+	 */
+	virtual void emit(bson::emitter& em) const;
+
 	/** Describe this artefact using BSON.
+	 * The default implementation builds a document from the output of
+	 * emit(). Subclasses must override at least one of these functions,
+	 * and should prefer emit() since it does not require a tree of
+	 * bson::value objects to be constructed.
 	 * @return a BSON description of this artefact.
 	 */
-	virtual bson::document to_bson() const = 0;
+	virtual bson::document to_bson() const;
 };
 
 } /* namespace holmes */
@@ -1,8 +1,9 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
+#include "holmes/bson/emitter.h"
 #include "holmes/bson/string.h"
 #include "holmes/bson/document.h"
 #include "holmes/bson/array.h"
@@ -20,38 +21,54 @@ bson::value* any::_null = new bson::null;
 any::any(unsigned char type, octet::string& bd) {
 	switch (type) {
 	case 0x02:
-		_ptr = new bson::string(bd, decode());
+		_ptr = _make<bson::string>(bd, decode());
 		break;
 	case 0x03:
-		_ptr = new bson::document(bd, decode());
+		_ptr = _make<bson::document>(bd, decode());
 		break;
 	case 0x04:
-		_ptr = new bson::array(bd, decode());
+		_ptr = _make<bson::array>(bd, decode());
 		break;
 	case 0x05:
-		_ptr = new bson::binary(bd, decode());
+		_ptr = _make<bson::binary>(bd, decode());
 		break;
 	case 0x08:
-		_ptr = new bson::boolean(bd, decode());
+		_ptr = _make<bson::boolean>(bd, decode());
 		break;
 	case 0x0a:
 		_ptr = _null;
 		break;
 	case 0x10:
-		_ptr = new bson::int32(bd, decode());
+		_ptr = _make<bson::int32>(bd, decode());
 		break;
 	case 0x12:
-		_ptr = new bson::int64(bd, decode());
+		_ptr = _make<bson::int64>(bd, decode());
 		break;
 	default:
 		throw std::invalid_argument("unsupported BSON type code");
 	}
 }
 
+any::~any() {
+	_destroy();
+}
+
+void any::_destroy() {
+	if (_is_inline()) {
+		_ptr->~value();
+	} else if (_ptr != _null) {
+		delete _ptr;
+	}
+}
+
 std::unique_ptr<value> any::clone() const {
 	return _ptr->clone();
 }
 
+value* any::clone_into(void* storage, size_t size) const {
+	return _ptr->clone_into(storage, size);
+}
+
 unsigned char any::type() const {
 	return _ptr->type();
 }
@@ -72,6 +89,10 @@ std::string any::to_json() const {
 	return _ptr->to_json();
 }
 
+void any::emit(emitter& em) const {
+	_ptr->emit(em);
+}
+
 value& any::operator*() {
 	return *_ptr;
 }
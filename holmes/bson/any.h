@@ -1,26 +1,89 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
 #ifndef HOLMES_BSON_ANY
 #define HOLMES_BSON_ANY
 
+#include <cstddef>
+#include <cstdint>
+#include <concepts>
+#include <new>
+#include <utility>
+#include <type_traits>
+
 #include "holmes/bson/value.h"
 
 namespace holmes::bson {
 
 class null;
 
-/** A class to represent a BSON value of any type. */
+/** A class to represent a BSON value of any type.
+ * Small values (which in practice means booleans, integers and null) are
+ * held within the object itself, so that they can be constructed, copied
+ * and moved without any memory allocation. Larger values are held on the
+ * heap.
+ */
 class any:
 	public value {
+public:
+	/** The size of the buffer for holding small values, in octets. */
+	static const size_t inline_size = 16;
 private:
 	/** A pointer to a shared copy of the null value. */
 	static holmes::bson::value* _null;
 
-	/** A pointer to the heap-allocated value of this object. */
+	/** A buffer for holding small values. */
+	alignas(int64_t) unsigned char _storage[inline_size];
+
+	/** A pointer to the value of this object.
+	 * This may point to _storage, to the shared null value, or to a
+	 * value allocated on the heap.
+	 */
 	value* _ptr;
+
+	/** Test whether the value of this object is held inline.
+	 * @return true if held inline, otherwise false
+	 */
+	bool _is_inline() const {
+		return static_cast<const void*>(_ptr) ==
+			static_cast<const void*>(_storage);
+	}
+
+	/** Destroy the value of this object.
+	 * The pointer is left dangling, so must be reassigned afterwards.
+	 */
+	void _destroy();
+
+	/** Take the value of another bson::any, leaving it null.
+	 * This object must not hold a value when this function is called.
+	 * @param that the value to be moved
+	 */
+	void _take(any& that) noexcept {
+		if (that._is_inline()) {
+			_ptr = that._ptr->clone_into(_storage, inline_size);
+			that._destroy();
+		} else {
+			_ptr = that._ptr;
+		}
+		that._ptr = _null;
+	}
+
+	/** Construct a specific type of bson::value, inline if it will fit.
+	 * @param args the arguments to be passed to the constructor of T
+	 * @return a pointer to the new value
+	 */
+	template<class T, class... Args>
+	value* _make(Args&&... args) {
+		if constexpr ((sizeof(T) <= inline_size) &&
+			(alignof(T) <= alignof(int64_t)) &&
+			std::is_nothrow_copy_constructible_v<T>) {
+			return new (_storage) T(std::forward<Args>(args)...);
+		} else {
+			return new T(std::forward<Args>(args)...);
+		}
+	}
 public:
 	/** Construct null value. */
 	any():
@@ -30,15 +93,13 @@ public:
 	 * @param that the value to be copied
 	 */
 	any(const any& that):
-		_ptr(that.clone().release()) {}
+		_ptr(that._ptr->clone_into(_storage, inline_size)) {}
 
 	/** Move-construct from another bson::any.
 	 * @param that the value to be moved
 	 */
-	any(any&& that):
-		_ptr(that._ptr) {
-
-		that._ptr = _null;
+	any(any&& that) noexcept {
+		_take(that);
 	}
 
 	/** Copy-assign from another bson::any.
@@ -47,10 +108,7 @@ public:
 	 */
 	any& operator=(const any& that) {
 		if (this != &that) {
-			if (_ptr != _null) {
-				delete _ptr;
-			}
-			_ptr = that.clone().release();
+			*this = *that._ptr;
 		}
 		return *this;
 	}
@@ -59,13 +117,10 @@ public:
 	 * @param that the value to be moved
 	 * @return a reference to this
 	 */
-	any& operator=(any&& that) {
+	any& operator=(any&& that) noexcept {
 		if (this != &that) {
-			if (_ptr != _null) {
-				delete _ptr;
-			}
-			_ptr = that._ptr;
-			that._ptr = _null;
+			_destroy();
+			_take(that);
 		}
 		return *this;
 	}
@@ -74,17 +129,36 @@ public:
 	 * @param that the value to be copied
 	 */
 	explicit any(const value& that):
-		_ptr((*that).clone().release()) {}
+		_ptr((*that).clone_into(_storage, inline_size)) {}
+
+	/** Move construct from a specific type of bson::value.
+	 * Small values are held inline. Otherwise the content of the value
+	 * is moved to the heap rather than cloned, so for documents and
+	 * arrays the cost is independent of their size.
+	 * @param that the value to be moved
+	 */
+	template<class T>
+	requires std::derived_from<T, value> && (!std::same_as<T, any>)
+	explicit any(T&& that):
+		_ptr(_make<std::remove_cv_t<T>>(std::move(that))) {}
+
+	/** Construct a specific type of bson::value in place.
+	 * @param args the arguments to be passed to the constructor of T
+	 */
+	template<class T, class... Args>
+	explicit any(std::in_place_type_t<T>, Args&&... args):
+		_ptr(_make<T>(std::forward<Args>(args)...)) {}
 
 	/** Copy assign from any type of bson::value.
 	 * @param that the value to be copied
 	 */
 	any& operator=(const value& that) {
 		if (this != &that) {
-			if (_ptr != _null) {
-				delete _ptr;
-			}
-			_ptr = (*that).clone().release();
+			// Make the copy before destroying the current value, in case
+			// one is contained within the other.
+			any copy(that);
+			_destroy();
+			_take(copy);
 		}
 		return *this;
 	}
@@ -97,18 +171,16 @@ public:
 	any(unsigned char type, octet::string& bd);
 
 	/** Destroy this value. */
-	~any() override {
-		if (_ptr != _null) {
-			delete _ptr;
-		}
-	}
+	~any() override;
 
 	std::unique_ptr<value> clone() const override;
+	value* clone_into(void* storage, size_t size) const override;
 	unsigned char type() const override;
 	size_t length() const override;
 	bool is_null() const override;
 	void encode(writer& bw) const override;
 	std::string to_json() const override;
+	void emit(emitter& em) const override;
 
 	value& operator*() override;
 	const value& operator*() const override;
@@ -1,9 +1,12 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
+#include <charconv>
+
 #include "holmes/bson/writer.h"
+#include "holmes/bson/emitter.h"
 #include "holmes/bson/array.h"
 
 namespace holmes::bson {
@@ -22,8 +25,7 @@ array::array(octet::string& bd, const decode& dec) {
 		if (k != std::to_string(index)) {
 			throw std::invalid_argument("unexpected key in BSON array");
 		}
-		auto v = any(type, content);
-		append(v);
+		append(any(type, content));
 		index += 1;
 		type = read_uint8(content);
 	}
@@ -34,7 +36,7 @@ std::unique_ptr<value> array::clone() const {
 }
 
 unsigned char array::type() const {
-	return 0x04;
+	return type_code;
 }
 
 size_t array::length() const {
@@ -54,15 +56,19 @@ size_t array::length() const {
 }
 
 void array::encode(writer& bw) const {
-	write_int32(bw, length());
+	size_t start = bw.size();
+	write_int32(bw, 0);
 	size_t index = 0;
 	for (auto& member : _members) {
 		write_uint8(bw, member.type());
-		write_cstring(bw, std::to_string(index).c_str());
+		char name[20];
+		auto [end, ec] = std::to_chars(name, name + sizeof(name), index);
+		write_cstring(bw, std::string_view(name, end - name));
 		member.encode(bw);
 		index += 1;
 	}
 	write_uint8(bw, 0);
+	patch_int32(bw, start, bw.size() - start);
 }
 
 std::string array::to_json() const {
@@ -81,6 +87,14 @@ std::string array::to_json() const {
 	return result;
 }
 
+void array::emit(emitter& em) const {
+	em.begin_array();
+	for (auto& member : _members) {
+		member.emit(em);
+	}
+	em.end_array();
+}
+
 bson::any& array::at(size_t index) {
 	return _members.at(index);
 }
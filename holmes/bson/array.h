@@ -1,5 +1,5 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
@@ -8,6 +8,7 @@
 
 #include <memory>
 #include <vector>
+#include <utility>
 
 #include "holmes/bson/value.h"
 #include "holmes/bson/any.h"
@@ -18,6 +19,9 @@ namespace holmes::bson {
 class array:
 	public value {
 public:
+	/** The type code for this class. */
+	static const unsigned char type_code = 0x04;
+
 	/** Construct empty BSON array. */
 	array() = default;
 
@@ -63,6 +67,7 @@ public:
 	size_t length() const override;
 	void encode(writer& bw) const override;
 	std::string to_json() const override ;
+	void emit(emitter& em) const override;
 
 	any& at(size_t index) override;
 	const any& at(size_t index) const override;
@@ -162,6 +167,26 @@ public:
 	 * @param value the value of the member
 	 */
 	void append(const bson::value& value);
+
+	/** Append a member to this array, moving rather than copying it.
+	 * @param value the value of the member
+	 */
+	template<class T>
+	requires std::derived_from<T, bson::value>
+	void append(T&& value) {
+		_members.emplace_back(std::move(value));
+	}
+
+	/** Construct a member of this array in place.
+	 * @param args the arguments to be passed to the constructor of T
+	 * @return a reference to the new value
+	 */
+	template<class T, class... Args>
+	T& emplace(Args&&... args) {
+		_members.emplace_back(std::in_place_type<T>,
+			std::forward<Args>(args)...);
+		return static_cast<T&>(*_members.back());
+	}
 };
 
 } /* namespace holmes::bson */
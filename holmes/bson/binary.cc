@@ -5,6 +5,7 @@
 
 #include "holmes/octet/base64/encoder.h"
 #include "holmes/bson/writer.h"
+#include "holmes/bson/emitter.h"
 #include "holmes/bson/binary.h"
 
 namespace holmes::bson {
@@ -30,7 +31,7 @@ std::unique_ptr<value> binary::clone() const {
 }
 
 unsigned char binary::type() const {
-	return 0x05;
+	return type_code;
 }
 
 size_t binary::length() const {
@@ -51,4 +52,8 @@ std::string binary::to_json() const {
 	return result;
 }
 
+void binary::emit(emitter& em) const {
+	em.binary(_value);
+}
+
 } /* namespace holmes::bson */
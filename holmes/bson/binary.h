@@ -1,5 +1,5 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
@@ -16,6 +16,9 @@ namespace holmes::bson {
 /** A BSON class to represent a binary string. */
 class binary:
 	public value {
+public:
+	/** The type code for this class. */
+	static const unsigned char type_code = 0x05;
 private:
 	/** The binary value. */
 	octet::string _value;
@@ -36,6 +39,7 @@ public:
 	size_t length() const override;
 	void encode(writer& bw) const override;
 	std::string to_json() const override;
+	void emit(emitter& em) const override;
 
 	operator octet::string() const override {
 		return _value;
@@ -1,9 +1,12 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
+#include <new>
+
 #include "holmes/bson/writer.h"
+#include "holmes/bson/emitter.h"
 #include "holmes/bson/boolean.h"
 
 namespace holmes::bson {
@@ -23,8 +26,15 @@ std::unique_ptr<value> boolean::clone() const {
 	return std::make_unique<boolean>(*this);
 }
 
+value* boolean::clone_into(void* storage, size_t size) const {
+	if (size < sizeof(boolean)) {
+		return clone().release();
+	}
+	return new (storage) boolean(*this);
+}
+
 unsigned char boolean::type() const {
-	return 0x08;
+	return type_code;
 }
 
 size_t boolean::length() const {
@@ -39,4 +49,8 @@ std::string boolean::to_json() const {
 	return (_value) ? "true" : "false";
 }
 
+void boolean::emit(emitter& em) const {
+	em.boolean(_value);
+}
+
 } /* namespace holmes::bson */
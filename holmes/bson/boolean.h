@@ -1,5 +1,5 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
@@ -13,6 +13,9 @@ namespace holmes::bson {
 /** A BSON class to represent a boolean value. */
 class boolean:
 	public value {
+public:
+	/** The type code for this class. */
+	static const unsigned char type_code = 0x08;
 private:
 	/** The boolean value. */
 	bool _value;
@@ -29,10 +32,12 @@ public:
 	explicit boolean(octet::string& bd, const decode& dec);
 
 	std::unique_ptr<value> clone() const override;
+	value* clone_into(void* storage, size_t size) const override;
 	unsigned char type() const override;
 	size_t length() const override;
 	void encode(writer& bw) const override;
 	std::string to_json() const override;
+	void emit(emitter& em) const override;
 
 	operator bool() const override {
 		return _value;
@@ -0,0 +1,107 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <charconv>
+#include <stdexcept>
+
+#include "holmes/bson/bson_emitter.h"
+
+namespace holmes::bson {
+
+void bson_emitter::_header(unsigned char type) {
+	if (_stack.empty()) {
+		if (type != 0x03) {
+			throw std::logic_error("outermost BSON value must be a document");
+		}
+		return;
+	}
+	write_uint8(*_out, type);
+	frame& top = _stack.back();
+	if (top.is_array) {
+		char name[20];
+		auto [end, ec] = std::to_chars(name, name + sizeof(name),
+			top.index++);
+		write_cstring(*_out, std::string_view(name, end - name));
+	} else {
+		write_cstring(*_out, _key_name);
+	}
+}
+
+void bson_emitter::_begin(unsigned char type) {
+	_header(type);
+	_stack.push_back(frame{_out->size(), type == 0x04, 0});
+	write_int32(*_out, 0);
+}
+
+void bson_emitter::_end() {
+	if (_stack.empty()) {
+		throw std::logic_error("unbalanced end of BSON document or array");
+	}
+	write_uint8(*_out, 0);
+	size_t offset = _stack.back().offset;
+	patch_int32(*_out, offset, _out->size() - offset);
+	_stack.pop_back();
+}
+
+void bson_emitter::_begin_document() {
+	_begin(0x03);
+}
+
+void bson_emitter::_end_document() {
+	_end();
+}
+
+void bson_emitter::_begin_array() {
+	_begin(0x04);
+}
+
+void bson_emitter::_end_array() {
+	_end();
+}
+
+bool bson_emitter::_key(std::string_view name) {
+	_name.assign(name);
+	_key_name = _name;
+	return true;
+}
+
+bool bson_emitter::_static_key(const static_key& key) {
+	_key_name = key.name();
+	return true;
+}
+
+void bson_emitter::_null() {
+	_header(0x0a);
+}
+
+void bson_emitter::_boolean(bool value) {
+	_header(0x08);
+	write_uint8(*_out, value);
+}
+
+void bson_emitter::_int32(int32_t value) {
+	_header(0x10);
+	write_int32(*_out, value);
+}
+
+void bson_emitter::_int64(int64_t value) {
+	_header(0x12);
+	write_int64(*_out, value);
+}
+
+void bson_emitter::_string(std::string_view value) {
+	_header(0x02);
+	write_int32(*_out, value.length() + 1);
+	write_cstring(*_out, value);
+}
+
+void bson_emitter::_binary(const octet::string& value) {
+	_header(0x05);
+	write_int32(*_out, value.length());
+	write_uint8(*_out, 0);
+	write(*_out, value.data(), value.length());
+}
+
+} /* namespace holmes::bson */
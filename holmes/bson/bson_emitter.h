@@ -0,0 +1,93 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_BSON_BSON_EMITTER
+#define HOLMES_BSON_BSON_EMITTER
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "holmes/bson/emitter.h"
+#include "holmes/bson/writer.h"
+
+namespace holmes::bson {
+
+/** An emitter class for writing binary BSON to a bson::writer.
+ * Each element is written as soon as its value is known. The length of
+ * each document or array is not known until it ends, so space is
+ * reserved for it at the start and filled in retrospectively.
+ */
+class bson_emitter:
+	public emitter {
+private:
+	/** A structure to represent a document or array which has not yet
+	 * been ended. */
+	struct frame {
+		/** The offset of the length field within the output. */
+		size_t offset;
+
+		/** True if this is an array, false if a document. */
+		bool is_array;
+
+		/** For an array, the index of the next element. */
+		size_t index;
+	};
+
+	/** The writer to receive the BSON. */
+	writer* _out;
+
+	/** The documents and arrays which have not yet been ended. */
+	std::vector<frame> _stack;
+
+	/** Storage for the name of the next member of the current document,
+	 * if it is not a static key. */
+	std::string _name;
+
+	/** The name of the next member of the current document.
+	 * This refers either to _name or to the storage of a static key.
+	 */
+	std::string_view _key_name;
+
+	/** Write an element header.
+	 * This consists of the type code followed by the element name, which
+	 * is the pending key in the case of a document, or the next index in
+	 * the case of an array. Nothing is written for the outermost document.
+	 * @param type the type code
+	 */
+	void _header(unsigned char type);
+
+	/** Begin a document or array.
+	 * @param type the type code
+	 */
+	void _begin(unsigned char type);
+
+	/** End the current document or array. */
+	void _end();
+protected:
+	void _begin_document() override;
+	void _end_document() override;
+	void _begin_array() override;
+	void _end_array() override;
+	bool _key(std::string_view name) override;
+	bool _static_key(const static_key& key) override;
+	void _null() override;
+	void _boolean(bool value) override;
+	void _int32(int32_t value) override;
+	void _int64(int64_t value) override;
+	void _string(std::string_view value) override;
+	void _binary(const octet::string& value) override;
+public:
+	/** Construct BSON emitter.
+	 * Output is appended to any existing content of the writer.
+	 * @param out the writer to receive the BSON
+	 */
+	explicit bson_emitter(writer& out):
+		_out(&out) {}
+};
+
+} /* namespace holmes::bson */
+
+#endif
@@ -0,0 +1,91 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <stdexcept>
+
+#include "holmes/bson/null.h"
+#include "holmes/bson/boolean.h"
+#include "holmes/bson/int32.h"
+#include "holmes/bson/int64.h"
+#include "holmes/bson/string.h"
+#include "holmes/bson/binary.h"
+#include "holmes/bson/builder.h"
+
+namespace holmes::bson {
+
+builder::frame& builder::_top() {
+	if (_stack.empty()) {
+		throw std::logic_error("outermost BSON value must be a document");
+	}
+	return _stack.back();
+}
+
+void builder::_begin_document() {
+	_stack.push_back(frame{_name, false, {}, {}});
+}
+
+void builder::_end_document() {
+	if (_stack.empty() || _stack.back().is_array) {
+		throw std::logic_error("unbalanced end of BSON document");
+	}
+	frame top = std::move(_stack.back());
+	_stack.pop_back();
+	if (_stack.empty()) {
+		_result = std::move(top.doc);
+	} else {
+		_name = std::move(top.name);
+		_emplace<bson::document>(std::move(top.doc));
+	}
+}
+
+void builder::_begin_array() {
+	_stack.push_back(frame{_name, true, {}, {}});
+}
+
+void builder::_end_array() {
+	if (_stack.empty() || !_stack.back().is_array) {
+		throw std::logic_error("unbalanced end of BSON array");
+	}
+	frame top = std::move(_stack.back());
+	_stack.pop_back();
+	_name = std::move(top.name);
+	_emplace<bson::array>(std::move(top.arr));
+}
+
+bool builder::_key(std::string_view name) {
+	_name.assign(name);
+	return true;
+}
+
+bool builder::_static_key(const static_key& key) {
+	_name.assign(key);
+	return true;
+}
+
+void builder::_null() {
+	_emplace<bson::null>();
+}
+
+void builder::_boolean(bool value) {
+	_emplace<bson::boolean>(value);
+}
+
+void builder::_int32(int32_t value) {
+	_emplace<bson::int32>(value);
+}
+
+void builder::_int64(int64_t value) {
+	_emplace<bson::int64>(value);
+}
+
+void builder::_string(std::string_view value) {
+	_emplace<bson::string>(std::string(value));
+}
+
+void builder::_binary(const octet::string& value) {
+	_emplace<bson::binary>(value);
+}
+
+} /* namespace holmes::bson */
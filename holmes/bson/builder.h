@@ -0,0 +1,100 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_BSON_BUILDER
+#define HOLMES_BSON_BUILDER
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "holmes/bson/emitter.h"
+#include "holmes/bson/document.h"
+#include "holmes/bson/array.h"
+
+namespace holmes::bson {
+
+/** An emitter class for building a tree of bson::value objects.
+ * This allows code which has been written to an emitter to be used
+ * where a bson::document is required.
+ */
+class builder:
+	public emitter {
+private:
+	/** A structure to represent a document or array which has not yet
+	 * been ended. */
+	struct frame {
+		/** The name of this value within its parent, if a document. */
+		document::key_type name;
+
+		/** True if this is an array, false if a document. */
+		bool is_array;
+
+		/** The content, if a document. */
+		bson::document doc;
+
+		/** The content, if an array. */
+		bson::array arr;
+	};
+
+	/** The documents and arrays which have not yet been ended. */
+	std::vector<frame> _stack;
+
+	/** The name of the next member of the current document. */
+	document::key_type _name = "";
+
+	/** The outermost document, once ended. */
+	bson::document _result;
+
+	/** Get the document or array which is currently being built.
+	 * @return the current frame
+	 * @throws std::logic_error if there is no current frame
+	 */
+	frame& _top();
+
+	/** Construct a value in place within the current document or array.
+	 * @param args the arguments to be passed to the constructor of T
+	 */
+	template<class T, class... Args>
+	void _emplace(Args&&... args) {
+		frame& top = _top();
+		if (top.is_array) {
+			top.arr.emplace<T>(std::forward<Args>(args)...);
+		} else {
+			top.doc.emplace<T>(_name, std::forward<Args>(args)...);
+		}
+	}
+protected:
+	void _begin_document() override;
+	void _end_document() override;
+	void _begin_array() override;
+	void _end_array() override;
+	bool _key(std::string_view name) override;
+	bool _static_key(const static_key& key) override;
+	void _null() override;
+	void _boolean(bool value) override;
+	void _int32(int32_t value) override;
+	void _int64(int64_t value) override;
+	void _string(std::string_view value) override;
+	void _binary(const octet::string& value) override;
+public:
+	/** Get the document which has been built.
+	 * @return the outermost document
+	 */
+	const bson::document& result() const {
+		return _result;
+	}
+
+	/** Take ownership of the document which has been built.
+	 * @return the outermost document
+	 */
+	bson::document release() {
+		return std::move(_result);
+	}
+};
+
+} /* namespace holmes::bson */
+
+#endif
@@ -1,5 +1,5 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
@@ -8,6 +8,7 @@
 #include <algorithm>
 
 #include "holmes/bson/writer.h"
+#include "holmes/bson/emitter.h"
 #include "holmes/bson/string.h"
 #include "holmes/bson/document.h"
 
@@ -23,8 +24,7 @@ document::document(octet::string& bd, const decode& dec) {
 	unsigned char type = read_uint8(content);
 	while (type != 0) {
 		std::string k = read_cstring(content);
-		auto v = any(type, content);
-		append(k, v);
+		append(std::move(k), any(type, content));
 		type = read_uint8(content);
 	}
 }
@@ -34,25 +34,28 @@ std::unique_ptr<value> document::clone() const {
 }
 
 unsigned char document::type() const {
-	return 0x03;
+	return type_code;
 }
 
 size_t document::length() const {
 	size_t len = 5;
 	for (auto& member : _members) {
-		len += 1 + member.first.length() + 1 + member.second.length();
+		len += 1 + member.first.name().length() + 1 +
+			member.second.length();
 	}
 	return len;
 }
 
 void document::encode(writer& bw) const {
-	write_int32(bw, length());
+	size_t start = bw.size();
+	write_int32(bw, 0);
 	for (auto& member : _members) {
 		write_uint8(bw, member.second.type());
-		write_cstring(bw, member.first.c_str());
+		write_cstring(bw, member.first.name());
 		member.second.encode(bw);
 	}
 	write_uint8(bw, 0);
+	patch_int32(bw, start, bw.size() - start);
 }
 
 std::string document::to_json() const {
@@ -65,7 +68,11 @@ std::string document::to_json() const {
 		} else {
 			result.push_back(',');
 		}
-		result.append(bson::string(member.first).to_json());
+		if (const static_key* key = member.first.as_static()) {
+			result.append(key->json());
+		} else {
+			append_json(result, member.first.name());
+		}
 		result.push_back(':');
 		result.append(member.second.to_json());
 	}
@@ -73,42 +80,64 @@ std::string document::to_json() const {
 	return result;
 }
 
-document::mapped_type& document::at(const std::string& name) {
-	value_type* found = 0;
+void document::emit(emitter& em) const {
+	em.begin_document();
 	for (auto& member : _members) {
-		if (member.first == name) {
-			if (found) {
-				throw std::out_of_range("out of range");
-			} else {
-				found = &member;
-			}
+		const static_key* key = member.first.as_static();
+		if ((key) ? em.key(*key) : em.key(member.first.name())) {
+			member.second.emit(em);
 		}
 	}
-	if (!found) {
-		throw std::out_of_range("out of range");
-	}
-	return found->second;
+	em.end_document();
 }
 
-const document::mapped_type& document::at(const std::string& name) const {
-	const value_type* found = 0;
-	for (const auto& member : _members) {
-		if (member.first == name) {
-			if (found) {
-				throw std::out_of_range("out of range");
-			} else {
-				found = &member;
+size_t document::_find(std::string_view name) const {
+	if (_members.size() < index_threshold) {
+		size_t found = ambiguous;
+		for (size_t i = 0; i != _members.size(); ++i) {
+			if (_members[i].first.name() == name) {
+				if (found != ambiguous) {
+					throw std::out_of_range("out of range");
+				}
+				found = i;
+			}
+		}
+		if (found == ambiguous) {
+			throw std::out_of_range("out of range");
+		}
+		return found;
+	}
+
+	if (!_index) {
+		auto index = std::make_unique<index_type>();
+		index->reserve(_members.size());
+		for (size_t i = 0; i != _members.size(); ++i) {
+			auto [entry, inserted] = index->try_emplace(
+				_members[i].first.name(), i);
+			if (!inserted) {
+				entry->second = ambiguous;
 			}
 		}
+		_index = std::move(index);
 	}
-	if (!found) {
+	auto f = _index->find(name);
+	if ((f == _index->end()) || (f->second == ambiguous)) {
 		throw std::out_of_range("out of range");
 	}
-	return found->second;
+	return f->second;
+}
+
+document::mapped_type& document::at(const std::string& name) {
+	return _members[_find(name)].second;
+}
+
+const document::mapped_type& document::at(const std::string& name) const {
+	return _members[_find(name)].second;
 }
 
-void document::append(const std::string& name, const value& value) {
-	_members.push_back(std::make_pair(name, bson::any(value)));
+void document::append(key_type name, const value& value) {
+	_index.reset();
+	_members.emplace_back(std::move(name), bson::any(value));
 }
 
 } /* namespace holmes::bson */
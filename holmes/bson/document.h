@@ -1,16 +1,22 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
 #ifndef HOLMES_BSON_DOCUMENT
 #define HOLMES_BSON_DOCUMENT
 
+#include <memory>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 
 #include "holmes/bson/value.h"
 #include "holmes/bson/any.h"
+#include "holmes/bson/static_key.h"
 
 namespace holmes::bson {
 
@@ -18,21 +24,90 @@ namespace holmes::bson {
 class document:
 	public value {
 public:
-	/** The key type for this document. */
-	typedef std::string key_type;
+	/** The type code for this class. */
+	static const unsigned char type_code = 0x03;
+
+	/** The key type for this document.
+	 * This is either an owned string or a static key.
+	 */
+	typedef member_name key_type;
 
 	/** The type to which keys are mapped by this document. */
 	typedef bson::any mapped_type;
 
 	/** The type of members of this document. */
 	typedef std::pair<key_type, mapped_type> value_type;
+
+	/** The minimum number of members for which lookup by name is indexed.
+	 * Below this, a linear search is faster than hashing the name.
+	 */
+	static const size_t index_threshold = 16;
 private:
+	/** A type for mapping member names to indices.
+	 * Names which occur more than once map to ambiguous.
+	 */
+	typedef std::unordered_map<std::string_view, size_t> index_type;
+
+	/** The index value for a name which occurs more than once. */
+	static const size_t ambiguous = static_cast<size_t>(-1);
+
 	/** The members of this document. */
 	std::vector<value_type> _members;
+
+	/** An index of members by name, or null if not yet built.
+	 * This is built on the first lookup by name if the document has at
+	 * least index_threshold members, and discarded whenever the members
+	 * are modified or moved. Note that building the index modifies the
+	 * document, so concurrent lookups require external synchronisation.
+	 */
+	mutable std::unique_ptr<index_type> _index;
+
+	/** Find the single member corresponding to a given name.
+	 * @param name the name of the member
+	 * @return the index of the member
+	 * @throws std::out_of_range unless there is exactly one match
+	 */
+	size_t _find(std::string_view name) const;
 public:
 	/** Construct empty BSON document. */
 	document() = default;
 
+	/** Copy-construct BSON document.
+	 * @param that the document to be copied
+	 */
+	document(const document& that):
+		_members(that._members) {}
+
+	/** Move-construct BSON document.
+	 * @param that the document to be moved
+	 */
+	document(document&& that) noexcept:
+		_members(std::move(that._members)) {
+
+		that._index.reset();
+	}
+
+	/** Copy-assign BSON document.
+	 * @param that the document to be copied
+	 * @return a reference to this
+	 */
+	document& operator=(const document& that) {
+		_members = that._members;
+		_index.reset();
+		return *this;
+	}
+
+	/** Move-assign BSON document.
+	 * @param that the document to be moved
+	 * @return a reference to this
+	 */
+	document& operator=(document&& that) noexcept {
+		_members = std::move(that._members);
+		_index.reset();
+		that._index.reset();
+		return *this;
+	}
+
 	/** Decode from an octet string.
 	 * @param bd the BSON data to be decoded
 	 * @param dec a flag to trigger decoding
@@ -44,6 +119,7 @@ public:
 	size_t length() const override;
 	void encode(writer& bw) const override;
 	std::string to_json() const override;
+	void emit(emitter& em) const override;
 
 	any& at(const std::string& name) override;
 	const any& at(const std::string& name) const override;
@@ -52,7 +128,34 @@ public:
 	 * @param name the name of the member
 	 * @param value the value of the member
 	 */
-	void append(const std::string& name, const bson::value& value);
+	void append(key_type name, const bson::value& value);
+
+	/** Append a member to this document, moving rather than copying
+	 * its value.
+	 * @param name the name of the member
+	 * @param value the value of the member
+	 */
+	template<class T>
+	requires std::derived_from<T, bson::value>
+	void append(key_type name, T&& value) {
+		_index.reset();
+		_members.emplace_back(std::move(name), bson::any(std::move(value)));
+	}
+
+	/** Construct a member of this document in place.
+	 * @param name the name of the member
+	 * @param args the arguments to be passed to the constructor of T
+	 * @return a reference to the new value
+	 */
+	template<class T, class... Args>
+	T& emplace(key_type name, Args&&... args) {
+		_index.reset();
+		_members.emplace_back(std::piecewise_construct,
+			std::forward_as_tuple(std::move(name)),
+			std::forward_as_tuple(std::in_place_type<T>,
+				std::forward<Args>(args)...));
+		return static_cast<T&>(*_members.back().second);
+	}
 };
 
 } /* namespace holmes::bson */
@@ -0,0 +1,185 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_BSON_EMITTER
+#define HOLMES_BSON_EMITTER
+
+#include <cstdint>
+#include <string_view>
+
+#include "holmes/octet/string.h"
+#include "holmes/bson/static_key.h"
+
+namespace holmes::bson {
+
+/** An abstract base class for receiving a stream of BSON events.
+ * This allows a structured value to be serialised directly into its
+ * final form, without first building a tree of bson::value objects.
+ *
+ * Within a document, each value must be preceded by a call to key().
+ * Within an array, keys are implied by position and key() must not be
+ * called. The outermost value must be a document.
+ *
+ * An emitter may indicate that it has no use for a member by returning
+ * false from key(). Callers should then skip that member entirely,
+ * which allows the cost of computing it to be avoided. Any value which
+ * is emitted regardless will be discarded.
+ */
+class emitter {
+protected:
+	/** Handle the start of a document. */
+	virtual void _begin_document() = 0;
+
+	/** Handle the end of a document. */
+	virtual void _end_document() = 0;
+
+	/** Handle the start of an array. */
+	virtual void _begin_array() = 0;
+
+	/** Handle the end of an array. */
+	virtual void _end_array() = 0;
+
+	/** Handle the name of the next member of a document.
+	 * @param name the name of the member
+	 * @return true if the member is wanted, otherwise false
+	 */
+	virtual bool _key(std::string_view name) = 0;
+
+	/** Handle the name of the next member of a document, where that name
+	 * is a static key.
+	 * The default implementation passes the name to _key. Emitters which
+	 * can make use of the static storage or the precomputed JSON form
+	 * should override this.
+	 * @param key the name of the member
+	 * @return true if the member is wanted, otherwise false
+	 */
+	virtual bool _static_key(const static_key& key) {
+		return _key(key.name());
+	}
+
+	/** Handle a null value. */
+	virtual void _null() = 0;
+
+	/** Handle a boolean value.
+	 * @param value the value
+	 */
+	virtual void _boolean(bool value) = 0;
+
+	/** Handle a 32-bit signed integer value.
+	 * @param value the value
+	 */
+	virtual void _int32(int32_t value) = 0;
+
+	/** Handle a 64-bit signed integer value.
+	 * @param value the value
+	 */
+	virtual void _int64(int64_t value) = 0;
+
+	/** Handle a character string value.
+	 * @param value the value
+	 */
+	virtual void _string(std::string_view value) = 0;
+
+	/** Handle a binary string value.
+	 * @param value the value
+	 */
+	virtual void _binary(const octet::string& value) = 0;
+public:
+	virtual ~emitter() = default;
+
+	/** Begin a document. */
+	void begin_document() {
+		_begin_document();
+	}
+
+	/** End the current document. */
+	void end_document() {
+		_end_document();
+	}
+
+	/** Begin an array. */
+	void begin_array() {
+		_begin_array();
+	}
+
+	/** End the current array. */
+	void end_array() {
+		_end_array();
+	}
+
+	/** Name the next member of the current document.
+	 * @param name the name of the member
+	 * @return true if the member is wanted, otherwise false
+	 */
+	bool key(std::string_view name) {
+		return _key(name);
+	}
+
+	/** Name the next member of the current document using a static key.
+	 * @param key the name of the member
+	 * @return true if the member is wanted, otherwise false
+	 */
+	bool key(const static_key& key) {
+		return _static_key(key);
+	}
+
+	/** Emit a null value. */
+	void null() {
+		_null();
+	}
+
+	/** Emit a boolean value.
+	 * @param value the value
+	 */
+	void boolean(bool value) {
+		_boolean(value);
+	}
+
+	/** Emit a 32-bit signed integer value.
+	 * @param value the value
+	 */
+	void int32(int32_t value) {
+		_int32(value);
+	}
+
+	/** Emit a 64-bit signed integer value.
+	 * @param value the value
+	 */
+	void int64(int64_t value) {
+		_int64(value);
+	}
+
+	/** Emit a character string value.
+	 * @param value the value
+	 */
+	void string(std::string_view value) {
+		_string(value);
+	}
+
+	/** Emit a binary string value.
+	 * @param value the value
+	 */
+	void binary(const octet::string& value) {
+		_binary(value);
+	}
+
+	/** Emit a value as a character string formatted using to_chars.
+	 * The type T must provide a constant named max_chars, and an overload
+	 * of to_chars which can be found by argument-dependent lookup. The
+	 * string is formatted into a buffer on the stack, so unlike conversion
+	 * to std::string, no memory allocation is required.
+	 * @param value the value to be formatted
+	 */
+	template<class T>
+	void formatted(const T& value) {
+		char buffer[T::max_chars];
+		auto result = to_chars(buffer, buffer + sizeof(buffer), value);
+		_string(std::string_view(buffer, result.ptr - buffer));
+	}
+};
+
+} /* namespace holmes::bson */
+
+#endif
@@ -0,0 +1,90 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <cstdint>
+
+#include "holmes/bson/file_reference.h"
+
+namespace holmes::bson {
+
+using namespace literals;
+
+file_reference::file_reference(emitter& out, const std::string& pathname,
+	const octet::string& content):
+	_out(&out),
+	_pathname(pathname),
+	_content(content) {}
+
+void file_reference::_begin_document() {
+	_out->begin_document();
+}
+
+void file_reference::_end_document() {
+	_out->end_document();
+}
+
+void file_reference::_begin_array() {
+	_out->begin_array();
+}
+
+void file_reference::_end_array() {
+	_out->end_array();
+}
+
+bool file_reference::_key(std::string_view name) {
+	return _out->key(name);
+}
+
+bool file_reference::_static_key(const static_key& key) {
+	return _out->key(key);
+}
+
+void file_reference::_null() {
+	_out->null();
+}
+
+void file_reference::_boolean(bool value) {
+	_out->boolean(value);
+}
+
+void file_reference::_int32(int32_t value) {
+	_out->int32(value);
+}
+
+void file_reference::_int64(int64_t value) {
+	_out->int64(value);
+}
+
+void file_reference::_string(std::string_view value) {
+	_out->string(value);
+}
+
+void file_reference::_binary(const octet::string& value) {
+	// Compare addresses as integers, since the pointers need not refer
+	// to the same object.
+	uintptr_t base = reinterpret_cast<uintptr_t>(_content.data());
+	uintptr_t start = reinterpret_cast<uintptr_t>(value.data());
+	if ((value.data() == nullptr) || (start < base) ||
+		(start - base > _content.length()) ||
+		(value.length() > _content.length() - (start - base))) {
+
+		_out->binary(value);
+		return;
+	}
+
+	_out->begin_document();
+	if (_out->key("file"_key)) {
+		_out->string(_pathname);
+	}
+	if (_out->key("offset"_key)) {
+		_out->int64(start - base);
+	}
+	if (_out->key("length"_key)) {
+		_out->int64(value.length());
+	}
+	_out->end_document();
+}
+
+} /* namespace holmes::bson */
@@ -0,0 +1,59 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_BSON_FILE_REFERENCE
+#define HOLMES_BSON_FILE_REFERENCE
+
+#include <string>
+
+#include "holmes/bson/emitter.h"
+
+namespace holmes::bson {
+
+/** An emitter class for replacing binary strings with references to the
+ * file from which they were obtained.
+ * When a file is accessed through octet::file, any octet string derived
+ * from it points directly into the mapped content. Binary strings which
+ * lie within that content are therefore passed on as a document of the
+ * form {"file": pathname, "offset": offset, "length": length} instead of
+ * as the octets themselves. All other events are passed on unchanged.
+ */
+class file_reference:
+	public emitter {
+private:
+	/** The emitter to receive the output. */
+	emitter* _out;
+
+	/** The pathname to be reported for the file. */
+	std::string _pathname;
+
+	/** The content of the file. */
+	octet::string _content;
+protected:
+	void _begin_document() override;
+	void _end_document() override;
+	void _begin_array() override;
+	void _end_array() override;
+	bool _key(std::string_view name) override;
+	bool _static_key(const static_key& key) override;
+	void _null() override;
+	void _boolean(bool value) override;
+	void _int32(int32_t value) override;
+	void _int64(int64_t value) override;
+	void _string(std::string_view value) override;
+	void _binary(const octet::string& value) override;
+public:
+	/** Construct file reference emitter.
+	 * @param out the emitter to receive the output
+	 * @param pathname the pathname to be reported for the file
+	 * @param content the content of the file
+	 */
+	file_reference(emitter& out, const std::string& pathname,
+		const octet::string& content);
+};
+
+} /* namespace holmes::bson */
+
+#endif
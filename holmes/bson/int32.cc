@@ -1,9 +1,12 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
+#include <new>
+
 #include "holmes/bson/writer.h"
+#include "holmes/bson/emitter.h"
 #include "holmes/bson/int32.h"
 
 namespace holmes::bson {
@@ -18,8 +21,15 @@ std::unique_ptr<value> int32::clone() const {
 	return std::make_unique<int32>(*this);
 }
 
+value* int32::clone_into(void* storage, size_t size) const {
+	if (size < sizeof(int32)) {
+		return clone().release();
+	}
+	return new (storage) int32(*this);
+}
+
 unsigned char int32::type() const {
-	return 0x10;
+	return type_code;
 }
 
 size_t int32::length() const {
@@ -34,4 +44,8 @@ std::string int32::to_json() const {
 	return std::to_string(_value);
 }
 
+void int32::emit(emitter& em) const {
+	em.int32(_value);
+}
+
 } /* namespace holmes::bson */
@@ -1,9 +1,12 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
+#include <new>
+
 #include "holmes/bson/writer.h"
+#include "holmes/bson/emitter.h"
 #include "holmes/bson/int64.h"
 
 namespace holmes::bson {
@@ -18,8 +21,15 @@ std::unique_ptr<value> int64::clone() const {
 	return std::make_unique<int64>(*this);
 }
 
+value* int64::clone_into(void* storage, size_t size) const {
+	if (size < sizeof(int64)) {
+		return clone().release();
+	}
+	return new (storage) int64(*this);
+}
+
 unsigned char int64::type() const {
-	return 0x12;
+	return type_code;
 }
 
 size_t int64::length() const {
@@ -34,4 +44,8 @@ std::string int64::to_json() const {
 	return std::to_string(_value);
 }
 
+void int64::emit(emitter& em) const {
+	em.int64(_value);
+}
+
 } /* namespace holmes::bson */
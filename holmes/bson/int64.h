@@ -1,5 +1,5 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
@@ -15,6 +15,9 @@ namespace holmes::bson {
 /** A BSON class to represent a 64-bit signed integer. */
 class int64:
 	public value {
+public:
+	/** The type code for this class. */
+	static const unsigned char type_code = 0x12;
 private:
 	/** The integer value. */
 	int64_t _value;
@@ -31,10 +34,12 @@ public:
 	explicit int64(octet::string& bd, const decode& dec);
 
 	std::unique_ptr<value> clone() const override;
+	value* clone_into(void* storage, size_t size) const override;
 	unsigned char type() const override;
 	size_t length() const override;
 	void encode(writer& bw) const override;
 	std::string to_json() const override;
+	void emit(emitter& em) const override;
 
 	operator int64_t() const override {
 		return _value;
@@ -0,0 +1,90 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <charconv>
+
+#include "holmes/octet/base64/encoder.h"
+#include "holmes/bson/string.h"
+#include "holmes/bson/json_emitter.h"
+
+namespace holmes::bson {
+
+void json_emitter::_begin_document() {
+	_separator();
+	_out->push_back('{');
+	_separate = false;
+}
+
+void json_emitter::_end_document() {
+	_out->push_back('}');
+	_separate = true;
+}
+
+void json_emitter::_begin_array() {
+	_separator();
+	_out->push_back('[');
+	_separate = false;
+}
+
+void json_emitter::_end_array() {
+	_out->push_back(']');
+	_separate = true;
+}
+
+bool json_emitter::_key(std::string_view name) {
+	_separator();
+	append_json(*_out, name);
+	_out->push_back(':');
+	_separate = false;
+	return true;
+}
+
+bool json_emitter::_static_key(const static_key& key) {
+	_separator();
+	_out->append(key.json());
+	_out->push_back(':');
+	_separate = false;
+	return true;
+}
+
+void json_emitter::_null() {
+	_separator();
+	_out->append("null");
+	_separate = true;
+}
+
+void json_emitter::_boolean(bool value) {
+	_separator();
+	_out->append((value) ? "true" : "false");
+	_separate = true;
+}
+
+void json_emitter::_int32(int32_t value) {
+	_int64(value);
+}
+
+void json_emitter::_int64(int64_t value) {
+	_separator();
+	char buffer[20];
+	auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+	_out->append(buffer, end);
+	_separate = true;
+}
+
+void json_emitter::_string(std::string_view value) {
+	_separator();
+	append_json(*_out, value);
+	_separate = true;
+}
+
+void json_emitter::_binary(const octet::string& value) {
+	_separator();
+	_out->append("{\"$binary\":{\"base64\":\"");
+	_out->append(octet::base64::encoder()(value, true));
+	_out->append("\",\"subtype\":0}}");
+	_separate = true;
+}
+
+} /* namespace holmes::bson */
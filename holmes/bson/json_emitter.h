@@ -0,0 +1,59 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_BSON_JSON_EMITTER
+#define HOLMES_BSON_JSON_EMITTER
+
+#include <string>
+
+#include "holmes/bson/emitter.h"
+
+namespace holmes::bson {
+
+/** An emitter class for writing extended JSON to a character buffer.
+ * The output is identical to that produced by bson::value::to_json for
+ * the equivalent tree of values, but is appended to a single buffer
+ * which can be reused from one document to the next.
+ */
+class json_emitter:
+	public emitter {
+private:
+	/** The buffer to receive the JSON. */
+	std::string* _out;
+
+	/** True if a separator is needed before the next member. */
+	bool _separate = false;
+
+	/** Write a separator if one is needed. */
+	void _separator() {
+		if (_separate) {
+			_out->push_back(',');
+		}
+	}
+protected:
+	void _begin_document() override;
+	void _end_document() override;
+	void _begin_array() override;
+	void _end_array() override;
+	bool _key(std::string_view name) override;
+	bool _static_key(const static_key& key) override;
+	void _null() override;
+	void _boolean(bool value) override;
+	void _int32(int32_t value) override;
+	void _int64(int64_t value) override;
+	void _string(std::string_view value) override;
+	void _binary(const octet::string& value) override;
+public:
+	/** Construct JSON emitter.
+	 * Output is appended to any existing content of the buffer.
+	 * @param out the buffer to receive the JSON
+	 */
+	explicit json_emitter(std::string& out):
+		_out(&out) {}
+};
+
+} /* namespace holmes::bson */
+
+#endif
@@ -1,8 +1,11 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
+#include <new>
+
+#include "holmes/bson/emitter.h"
 #include "holmes/bson/null.h"
 
 namespace holmes::bson {
@@ -11,8 +14,15 @@ std::unique_ptr<value> null::clone() const {
 	return std::make_unique<null>();
 }
 
+value* null::clone_into(void* storage, size_t size) const {
+	if (size < sizeof(null)) {
+		return clone().release();
+	}
+	return new (storage) null(*this);
+}
+
 unsigned char null::type() const {
-	return 0x0a;
+	return type_code;
 }
 
 size_t null::length() const {
@@ -29,4 +39,8 @@ std::string null::to_json() const {
 	return "null";
 }
 
+void null::emit(emitter& em) const {
+	em.null();
+}
+
 } /* namespace holmes::bson */
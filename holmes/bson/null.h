@@ -1,5 +1,5 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
@@ -14,12 +14,17 @@ namespace holmes::bson {
 class null:
 	public value {
 public:
+	/** The type code for this class. */
+	static const unsigned char type_code = 0x0a;
+
 	std::unique_ptr<value> clone() const override;
+	value* clone_into(void* storage, size_t size) const override;
 	unsigned char type() const override;
 	size_t length() const override;
 	bool is_null() const override;
 	void encode(writer& bw) const override;
 	std::string to_json() const override;
+	void emit(emitter& em) const override;
 };
 
 } /* namespace holmes::bson */
@@ -0,0 +1,185 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <algorithm>
+
+#include "holmes/bson/projection.h"
+
+namespace holmes::bson {
+
+projection::projection(emitter& out, const std::vector<std::string>& fields):
+	_out(&out) {
+
+	for (const std::string& field : fields) {
+		node* level = &_root;
+		size_t start = 0;
+		while (true) {
+			size_t end = field.find('.', start);
+			std::string_view name = std::string_view(field).substr(
+				start, (end == std::string::npos) ? end : end - start);
+			auto f = std::find_if(level->children.begin(),
+				level->children.end(),
+				[name](const node& child) { return child.name == name; });
+			if (f == level->children.end()) {
+				level = &level->children.emplace_back();
+				level->name = name;
+			} else {
+				level = &*f;
+			}
+			if (end == std::string::npos) {
+				break;
+			}
+			start = end + 1;
+		}
+		level->field = true;
+	}
+}
+
+const projection::node* projection::node::find(std::string_view name) const {
+	for (const node& child : children) {
+		if (child.name == name) {
+			return &child;
+		}
+	}
+	return nullptr;
+}
+
+bool projection::_discard_scalar() {
+	if (_discard_depth != 0) {
+		return true;
+	}
+	if (_discard) {
+		_discard = false;
+		return true;
+	}
+	return false;
+}
+
+bool projection::_begin(bool is_array) {
+	if (_discard_depth != 0) {
+		_discard_depth += 1;
+		return false;
+	}
+	if (_discard) {
+		_discard = false;
+		_discard_depth = 1;
+		return false;
+	}
+	// Array elements do not contribute to the path, so a value within
+	// an array has the same node as the array itself.
+	const node* level = &_root;
+	if (!_stack.empty()) {
+		level = (_stack.back().is_array) ? _stack.back().level : _member;
+	}
+	_stack.push_back(frame{level, is_array});
+	return true;
+}
+
+bool projection::_end() {
+	if (_discard_depth != 0) {
+		_discard_depth -= 1;
+		return false;
+	}
+
+	// If the last member was rejected then the caller will have skipped
+	// it, so the flag must not carry over into whatever follows.
+	_discard = false;
+	if (!_stack.empty()) {
+		_stack.pop_back();
+	}
+	return true;
+}
+
+void projection::_begin_document() {
+	if (_begin(false)) {
+		_out->begin_document();
+	}
+}
+
+void projection::_end_document() {
+	if (_end()) {
+		_out->end_document();
+	}
+}
+
+void projection::_begin_array() {
+	if (_begin(true)) {
+		_out->begin_array();
+	}
+}
+
+void projection::_end_array() {
+	if (_end()) {
+		_out->end_array();
+	}
+}
+
+bool projection::_select_member(std::string_view name) {
+	const node* level = (_stack.empty()) ? &_root : _stack.back().level;
+	if (!level) {
+		_member = nullptr;
+		return true;
+	}
+	const node* child = level->find(name);
+	if (!child) {
+		return false;
+	}
+	_member = (child->field) ? nullptr : child;
+	return true;
+}
+
+bool projection::_key(std::string_view name) {
+	if (_discard_depth != 0) {
+		return false;
+	}
+	_discard = !(_select_member(name) && _out->key(name));
+	return !_discard;
+}
+
+bool projection::_static_key(const static_key& key) {
+	if (_discard_depth != 0) {
+		return false;
+	}
+	_discard = !(_select_member(key.name()) && _out->key(key));
+	return !_discard;
+}
+
+void projection::_null() {
+	if (!_discard_scalar()) {
+		_out->null();
+	}
+}
+
+void projection::_boolean(bool value) {
+	if (!_discard_scalar()) {
+		_out->boolean(value);
+	}
+}
+
+void projection::_int32(int32_t value) {
+	if (!_discard_scalar()) {
+		_out->int32(value);
+	}
+}
+
+void projection::_int64(int64_t value) {
+	if (!_discard_scalar()) {
+		_out->int64(value);
+	}
+}
+
+void projection::_string(std::string_view value) {
+	if (!_discard_scalar()) {
+		_out->string(value);
+	}
+}
+
+void projection::_binary(const octet::string& value) {
+	if (!_discard_scalar()) {
+		_out->binary(value);
+	}
+}
+
+} /* namespace holmes::bson */
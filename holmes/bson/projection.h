@@ -0,0 +1,127 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_BSON_PROJECTION
+#define HOLMES_BSON_PROJECTION
+
+#include <string>
+#include <vector>
+
+#include "holmes/bson/emitter.h"
+
+namespace holmes::bson {
+
+/** An emitter class for passing on only selected members to another
+ * emitter.
+ * Fields are specified as paths of member names separated by dots, for
+ * example "tcp.checksum.calculated". Array elements do not contribute
+ * to the path, so "tcp.options.type" selects the type of every option.
+ * A member is passed on if its path is equal to one of the fields, lies
+ * beneath one of the fields, or is an ancestor of one of the fields.
+ * For any other member, key() returns false so that the value need not
+ * be computed.
+ */
+class projection:
+	public emitter {
+private:
+	/** A structure to represent one level of the selected paths.
+	 * The selected fields form a tree, with one node for each distinct
+	 * prefix, so that a member can be tested by looking up its name
+	 * among the children of its parent without building its full path.
+	 */
+	struct node {
+		/** The name of the member at this level. */
+		std::string name;
+
+		/** True if this node is one of the selected fields, in which case
+		 * everything beneath it is selected too. */
+		bool field = false;
+
+		/** The nodes for the members at the next level down. */
+		std::vector<node> children;
+
+		/** Find a child node by name.
+		 * @param name the name of the child
+		 * @return the child, or null if not found
+		 */
+		const node* find(std::string_view name) const;
+	};
+
+	/** A structure to represent a document or array which has not yet
+	 * been ended. */
+	struct frame {
+		/** The node for this value, or null if it lies beneath a
+		 * selected field. */
+		const node* level;
+
+		/** True if this is an array, false if a document. */
+		bool is_array;
+	};
+
+	/** The emitter to receive the selected members. */
+	emitter* _out;
+
+	/** The root of the tree of selected paths. */
+	node _root;
+
+	/** The node for the most recently named member, or null if it lies
+	 * beneath a selected field. */
+	const node* _member = nullptr;
+
+	/** The documents and arrays which have not yet been ended. */
+	std::vector<frame> _stack;
+
+	/** True if the next value is to be discarded. */
+	bool _discard = false;
+
+	/** The depth of nesting within a discarded document or array,
+	 * or zero if none. */
+	size_t _discard_depth = 0;
+
+	/** Record the name of the next member, and test whether it is selected.
+	 * @param name the name of the member
+	 * @return true if selected, otherwise false
+	 */
+	bool _select_member(std::string_view name);
+
+	/** Test whether a scalar value should be discarded.
+	 * @return true if it should be discarded, otherwise false
+	 */
+	bool _discard_scalar();
+
+	/** Begin a document or array.
+	 * @param is_array true if an array, false if a document
+	 * @return true if it should be passed on, otherwise false
+	 */
+	bool _begin(bool is_array);
+
+	/** End a document or array.
+	 * @return true if it should be passed on, otherwise false
+	 */
+	bool _end();
+protected:
+	void _begin_document() override;
+	void _end_document() override;
+	void _begin_array() override;
+	void _end_array() override;
+	bool _key(std::string_view name) override;
+	bool _static_key(const static_key& key) override;
+	void _null() override;
+	void _boolean(bool value) override;
+	void _int32(int32_t value) override;
+	void _int64(int64_t value) override;
+	void _string(std::string_view value) override;
+	void _binary(const octet::string& value) override;
+public:
+	/** Construct projection.
+	 * @param out the emitter to receive the selected members
+	 * @param fields the paths of the fields to be selected
+	 */
+	projection(emitter& out, const std::vector<std::string>& fields);
+};
+
+} /* namespace holmes::bson */
+
+#endif
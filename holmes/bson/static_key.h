@@ -0,0 +1,198 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_BSON_STATIC_KEY
+#define HOLMES_BSON_STATIC_KEY
+
+#include <cstddef>
+#include <array>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace holmes::bson {
+
+/** A class to represent a document member name held in static storage.
+ * Static keys are intended for the fixed member names used when
+ * serialising artefacts. They are created using the _key literal suffix,
+ * for example "src_port"_key, which interns the name at compile time
+ * along with its encoded forms. Documents and emitters can then refer to
+ * the name by pointer, without copying it, and write it as JSON or BSON
+ * without escaping or measuring it.
+ *
+ * Static keys are restricted to printable ASCII characters other than
+ * quotation marks and backslashes, so that the JSON form is simply the
+ * name enclosed in quotation marks.
+ */
+class static_key {
+private:
+	/** The name, enclosed in quotation marks, and null-terminated. */
+	const char* _quoted;
+
+	/** The length of the name, excluding quotation marks. */
+	size_t _length;
+public:
+	/** Construct static key.
+	 * This is intended for use by the _key literal suffix.
+	 * @param quoted the name, enclosed in quotation marks and followed
+	 *  by a null terminator, in static storage
+	 * @param length the length of the name
+	 */
+	constexpr static_key(const char* quoted, size_t length):
+		_quoted(quoted),
+		_length(length) {}
+
+	/** Get the name.
+	 * @return the name
+	 */
+	constexpr std::string_view name() const {
+		return std::string_view(_quoted + 1, _length);
+	}
+
+	/** Get the name as a JSON string.
+	 * @return the name, enclosed in quotation marks
+	 */
+	constexpr std::string_view json() const {
+		return std::string_view(_quoted, _length + 2);
+	}
+};
+
+/** A structural type for passing a string literal as a template argument.
+ * @tparam N the length of the string, including the null terminator
+ */
+template<size_t N>
+struct key_chars {
+	/** The characters of the string, including the null terminator. */
+	char value[N];
+
+	/** Construct from a string literal.
+	 * @param chars the string literal
+	 */
+	constexpr key_chars(const char (&chars)[N]) {
+		for (size_t i = 0; i != N; ++i) {
+			value[i] = chars[i];
+		}
+	}
+
+	/** Test whether this string can be used as a static key.
+	 * @return true if valid, otherwise false
+	 */
+	constexpr bool valid() const {
+		for (size_t i = 0; i != N - 1; ++i) {
+			char c = value[i];
+			if ((c < 0x20) || (c >= 0x7f) || (c == '"') || (c == '\\')) {
+				return false;
+			}
+		}
+		return value[N - 1] == 0;
+	}
+};
+
+/** A class to hold the static storage for an interned key.
+ * There is exactly one instance of the storage for each distinct name.
+ * @tparam K the name
+ */
+template<key_chars K>
+struct interned_key {
+	static_assert(K.valid(),
+		"static BSON keys must be printable ASCII without quotes or backslashes");
+
+	/** The length of the name. */
+	static constexpr size_t length = sizeof(K.value) - 1;
+
+	/** The name, enclosed in quotation marks, and null-terminated. */
+	static constexpr std::array<char, length + 3> quoted = []() {
+		std::array<char, length + 3> result{};
+		result[0] = '"';
+		for (size_t i = 0; i != length; ++i) {
+			result[i + 1] = K.value[i];
+		}
+		result[length + 1] = '"';
+		result[length + 2] = 0;
+		return result;
+	}();
+
+	/** The static key. */
+	static constexpr static_key key{quoted.data(), length};
+};
+
+/** A class to represent the name of a document member.
+ * This is either a static key, which is referred to by pointer, or a
+ * string which is owned by this object.
+ */
+class member_name {
+private:
+	/** The static key, or null if the name is owned. */
+	const static_key* _static = nullptr;
+
+	/** The owned name, if there is no static key. */
+	std::string _owned;
+public:
+	/** Construct from an owned string.
+	 * @param name the name
+	 */
+	member_name(std::string name):
+		_owned(std::move(name)) {}
+
+	/** Construct from a character array.
+	 * @param name the name
+	 */
+	member_name(const char* name):
+		_owned(name) {}
+
+	/** Construct from a static key.
+	 * @param key the key
+	 */
+	member_name(const static_key& key):
+		_static(&key) {}
+
+	/** Replace with an owned string.
+	 * Any existing owned storage is reused where possible.
+	 * @param name the name
+	 */
+	void assign(std::string_view name) {
+		_static = nullptr;
+		_owned.assign(name);
+	}
+
+	/** Replace with a static key.
+	 * @param key the key
+	 */
+	void assign(const static_key& key) {
+		_static = &key;
+		_owned.clear();
+	}
+
+	/** Get the static key, if there is one.
+	 * @return the static key, or null if the name is owned
+	 */
+	const static_key* as_static() const {
+		return _static;
+	}
+
+	/** Get the name.
+	 * @return the name
+	 */
+	std::string_view name() const {
+		return (_static) ? _static->name() : std::string_view(_owned);
+	}
+};
+
+namespace literals {
+
+/** Create a static key from a string literal.
+ * @tparam K the name
+ * @return the static key
+ */
+template<key_chars K>
+constexpr const static_key& operator""_key() {
+	return interned_key<K>::key;
+}
+
+} /* namespace literals */
+
+} /* namespace holmes::bson */
+
+#endif
@@ -1,14 +1,20 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
-#include <cstdio>
+#include <algorithm>
 #include <stdexcept>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 #include "holmes/parse_error.h"
-#include "holmes/unicode/utf8/decoder.h"
+#include "holmes/octet/simd.h"
 #include "holmes/bson/writer.h"
+#include "holmes/bson/emitter.h"
 #include "holmes/bson/string.h"
 
 namespace holmes::bson {
@@ -16,6 +22,9 @@ namespace holmes::bson {
 string::string(const std::string& value):
 	_value(value) {}
 
+string::string(std::string&& value):
+	_value(std::move(value)) {}
+
 string::string(octet::string& bd, const value::decode& dec) {
 	int32_t length = read_int32(bd, -1);
 	if (length < 1) {
@@ -36,7 +45,7 @@ std::unique_ptr<value> string::clone() const {
 }
 
 unsigned char string::type() const {
-	return 0x02;
+	return type_code;
 }
 
 size_t string::length() const {
@@ -50,80 +59,248 @@ void string::encode(writer& bw) const {
 }
 
 std::string string::to_json() const {
-	// Characters are escaped only if they must be.
+	std::string result;
+	append_json(result, _value);
+	return result;
+}
+
+void string::emit(emitter& em) const {
+	em.string(_value);
+}
+
+/** Test whether a character can be copied into a JSON string verbatim.
+ * This excludes control characters, quotation marks and backslashes,
+ * which must be escaped, and non-ASCII characters, which are escaped
+ * as a matter of policy after being validated as UTF-8.
+ * @param c the character to be tested
+ * @return true if the character can be copied, otherwise false
+ */
+static bool is_plain(unsigned char c) {
+	return (c >= 0x20) && (c < 0x80) && (c != '"') && (c != '\\');
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/** Skip over plain characters 16 at a time using SSE2.
+ * Comparing as signed octets allows control characters and non-ASCII
+ * characters to be detected using a single comparison.
+ * @param data the characters to be scanned
+ * @param length the number of characters available
+ * @return the number of plain characters skipped
+ */
+__attribute__((target("sse2")))
+static size_t skip_plain_sse2(const char* data, size_t length) {
+	const __m128i space = _mm_set1_epi8(0x20);
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+
+	size_t done = 0;
+	while (length - done >= 16) {
+		__m128i v = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(data + done));
+		__m128i special = _mm_or_si128(_mm_cmplt_epi8(v, space),
+			_mm_or_si128(_mm_cmpeq_epi8(v, quote),
+			_mm_cmpeq_epi8(v, backslash)));
+		unsigned int mask = _mm_movemask_epi8(special);
+		if (mask != 0) {
+			return done + __builtin_ctz(mask);
+		}
+		done += 16;
+	}
+	return done;
+}
+
+/** Skip over plain characters 32 at a time using AVX2.
+ * @param data the characters to be scanned
+ * @param length the number of characters available
+ * @return the number of plain characters skipped
+ */
+__attribute__((target("avx2")))
+static size_t skip_plain_avx2(const char* data, size_t length) {
+	const __m256i space = _mm256_set1_epi8(0x20);
+	const __m256i quote = _mm256_set1_epi8('"');
+	const __m256i backslash = _mm256_set1_epi8('\\');
+
+	size_t done = 0;
+	while (length - done >= 32) {
+		__m256i v = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(data + done));
+		__m256i special = _mm256_or_si256(_mm256_cmpgt_epi8(space, v),
+			_mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+			_mm256_cmpeq_epi8(v, backslash)));
+		unsigned int mask = _mm256_movemask_epi8(special);
+		if (mask != 0) {
+			return done + __builtin_ctz(mask);
+		}
+		done += 32;
+	}
+	return done;
+}
+
+#endif
+
+/** Skip over characters which can be copied into a JSON string verbatim.
+ * @param level the level of vector support to be used
+ * @param data the characters to be scanned
+ * @param length the number of characters available
+ * @return the number of plain characters skipped
+ */
+static size_t skip_plain(octet::simd_level level, const char* data,
+	size_t length) {
+
+	size_t done = 0;
+#if defined(__x86_64__) || defined(__i386__)
+	// The AVX2 stage can only stop with 32 or more characters remaining
+	// if it has found a character which is not plain, in which case the
+	// SSE2 stage is not needed.
+	switch (level) {
+	case octet::simd_level::avx2:
+		done = skip_plain_avx2(data, length);
+		if (length - done >= 32) {
+			return done;
+		}
+		[[fallthrough]];
+	case octet::simd_level::ssse3:
+		done += skip_plain_sse2(data + done, length - done);
+		break;
+	default:
+		break;
+	}
+#endif
+	while ((done != length) && is_plain(data[done])) {
+		++done;
+	}
+	return done;
+}
+
+/** Append a JSON escape sequence for a UTF-16 code unit.
+ * @param result the string to which the escape sequence is appended
+ * @param unit the code unit to be escaped
+ */
+static void append_escape(std::string& result, uint16_t unit) {
+	static const char* digits = "0123456789ABCDEF";
+	char buffer[6] = {'\\', 'u',
+		digits[(unit >> 12) & 0xf], digits[(unit >> 8) & 0xf],
+		digits[(unit >> 4) & 0xf], digits[(unit >> 0) & 0xf]};
+	result.append(buffer, sizeof(buffer));
+}
+
+/** Decode a non-ASCII code point from UTF-8.
+ * The validation performed is the same as for unicode::utf8::decoder,
+ * but without the need to construct an octet string.
+ * @param value the string from which the code point is to be decoded
+ * @param index the index of the first octet, updated to the index of
+ *  the octet which follows the code point
+ * @return the code point
+ * @throws parse_error if the string does not contain valid UTF-8
+ */
+static uint32_t decode_utf8(std::string_view value, size_t& index) {
+	uint32_t cp = static_cast<unsigned char>(value[index++]);
+	uint32_t limit = 0;
+	unsigned int extra = 0;
+	if ((cp & 0xe0) == 0xc0) {
+		cp &= 0x1f;
+		limit = 0x80;
+		extra = 1;
+	} else if ((cp & 0xf0) == 0xe0) {
+		cp &= 0x0f;
+		limit = 0x800;
+		extra = 2;
+	} else if ((cp & 0xf8) == 0xf0) {
+		cp &= 0x07;
+		limit = 0x10000;
+		extra = 3;
+	} else {
+		throw parse_error("invalid UTF-8");
+	}
+	if (value.length() - index < extra) {
+		throw parse_error("unexpected end of UTF-8");
+	}
+	for (unsigned int i = 0; i != extra; ++i) {
+		uint32_t ecp = static_cast<unsigned char>(value[index++]);
+		if ((ecp & 0xc0) != 0x80) {
+			throw parse_error("invalid UTF-8");
+		}
+		cp <<= 6;
+		cp |= ecp & 0x3f;
+	}
+	if (cp < limit) {
+		throw parse_error("non-canonical UTF-8");
+	}
+	if ((cp >= 0xd800) && (cp < 0xe000)) {
+		throw parse_error("surrogate in UTF-8");
+	}
+	if (cp >= 0x110000) {
+		throw parse_error("code point out of range");
+	}
+	return cp;
+}
+
+void append_json(std::string& result, std::string_view value) {
+	// Characters are escaped only if they must be, or if they are
+	// non-ASCII. Runs of characters which need no escaping are located
+	// using vector instructions where available, then copied in bulk.
 	// The reserved capacity currently makes no allowance for escaped
 	// characters, however scanning would be necessary to obtain an
 	// accurate predication in all cases, and for typical workloads
 	// there would be a risk of this doing more harm than good.
-	std::string result;
-	result.reserve(_value.length() + 2);
+	result.reserve(result.length() + value.length() + 2);
 	result.push_back('"');
-	octet::string octets(
-		reinterpret_cast<const unsigned char*>(_value.data()),
-		_value.length());
-	unicode::utf8::decoder decoder(octets);
-	while (decoder) {
-		uint32_t cp = decoder();
-		if (cp < 0x20) {
-			switch (cp) {
+	// A run which follows a short one is likely to be short too, and
+	// for short runs a 32-character scan using AVX2 costs more than a
+	// 16-character scan using SSE2, so AVX2 is used only for the first
+	// run and those which follow a run of at least 32 characters.
+	octet::simd_level level = octet::simd_support();
+	octet::simd_level short_level = std::min(level, octet::simd_level::ssse3);
+	size_t index = 0;
+	size_t count = 32;
+	while (index != value.length()) {
+		count = skip_plain((count < 32) ? short_level : level,
+			value.data() + index, value.length() - index);
+		result.append(value.data() + index, count);
+		index += count;
+		if (index == value.length()) {
+			break;
+		}
+
+		unsigned char c = value[index];
+		if (c < 0x20) {
+			switch (c) {
 			case '\b':
-				result.push_back('\\');
-				result.push_back('b');
+				result.append("\\b", 2);
 				break;
 			case '\t':
-				result.push_back('\\');
-				result.push_back('t');
+				result.append("\\t", 2);
 				break;
 			case '\n':
-				result.push_back('\\');
-				result.push_back('n');
+				result.append("\\n", 2);
 				break;
 			case '\f':
-				result.push_back('\\');
-				result.push_back('f');
+				result.append("\\f", 2);
 				break;
 			case '\r':
-				result.push_back('\\');
-				result.push_back('r');
+				result.append("\\r", 2);
 				break;
 			default:
-				char buffer[7];
-				sprintf(buffer, "\\u%04X", cp);
-				result.append(buffer);
+				append_escape(result, c);
 				break;
 			}
-		} else if (cp < 0x80) {
-			switch (cp) {
-			case '"':
-				result.push_back('\\');
-				result.push_back('\"');
-				break;
-			case '\\':
-				result.push_back('\\');
-				result.push_back('\\');
-				break;
-			default:
-				result.push_back(cp);
-				break;
-			}
-		} else if (cp < 0x10000) {
-			char buffer[7];
-			sprintf(buffer, "\\u%04X", cp);
-			result.append(buffer);
-			break;
-		} else if (cp < 0x110000) {
-			uint16_t hscp = 0xd800 + ((cp - 0x10000) >> 10);
-			uint16_t lscp = 0xdc00 + ((cp - 0x10000) & 0x3ff);
-			char buffer[14];
-			sprintf(buffer, "\\u%04X\\u%04X", hscp, lscp);
-			result.append(buffer);
-			break;
+			++index;
+		} else if (c < 0x80) {
+			result.push_back('\\');
+			result.push_back(c);
+			++index;
 		} else {
-			throw parse_error("code point out of range");
+			uint32_t cp = decode_utf8(value, index);
+			if (cp < 0x10000) {
+				append_escape(result, cp);
+			} else {
+				append_escape(result, 0xd800 + ((cp - 0x10000) >> 10));
+				append_escape(result, 0xdc00 + ((cp - 0x10000) & 0x3ff));
+			}
 		}
 	}
 	result.push_back('"');
-	return result;
 }
 
 } /* namespace holmes::bson */
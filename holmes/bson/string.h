@@ -1,5 +1,5 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
@@ -7,6 +7,7 @@
 #define HOLMES_BSON_STRING
 
 #include <string>
+#include <string_view>
 
 #include "holmes/bson/value.h"
 
@@ -15,6 +16,9 @@ namespace holmes::bson {
 /** A BSON class to represent a UTF-8 string. */
 class string:
 	public value {
+public:
+	/** The type code for this class. */
+	static const unsigned char type_code = 0x02;
 private:
 	/** The string value. */
 	std::string _value;
@@ -24,6 +28,11 @@ public:
 	 */
 	explicit string(const std::string& value);
 
+	/** Construct BSON value containing UTF-8 string.
+	 * @param value the required string value, to be moved
+	 */
+	explicit string(std::string&& value);
+
 	/** Decode from an octet string.
 	 * @param bd the BSON data to be decoded
 	 * @param dec a flag to trigger decoding
@@ -35,12 +44,19 @@ public:
 	size_t length() const override;
 	void encode(writer& bw) const override;
 	std::string to_json() const override;
+	void emit(emitter& em) const override;
 
 	operator std::string() const override {
 		return _value;
 	}
 };
 
+/** Append a character string to a buffer as a quoted JSON string.
+ * @param result the buffer to be appended to
+ * @param value the character string to be encoded
+ */
+void append_json(std::string& result, std::string_view value);
+
 } /* namespace holmes::bson */
 
 #endif
@@ -1,5 +1,5 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
@@ -9,6 +9,10 @@
 
 namespace holmes::bson {
 
+value* value::clone_into(void* storage, size_t size) const {
+	return clone().release();
+}
+
 bool value::is_null() const {
 	return false;
 }
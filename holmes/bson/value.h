@@ -7,16 +7,29 @@
 #define HOLMES_BSON_VALUE
 
 #include <cstddef>
+#include <concepts>
 #include <memory>
 #include <string>
+#include <typeinfo>
 
 #include "holmes/octet/string.h"
 
 namespace holmes::bson {
 
 class writer;
+class emitter;
 class any;
 
+/** A concept satisfied by classes which represent a single BSON type.
+ * Each such class declares the type code which it represents, and is
+ * the only class to return that type code from type(), other than
+ * bson::any which returns the type code of its underlying value.
+ */
+template<class T>
+concept has_type_code = requires {
+	{ T::type_code } -> std::convertible_to<unsigned char>;
+};
+
 /** An abstract base class to represent a BSON value of any type. */
 class value {
 public:
@@ -30,6 +43,18 @@ public:
 	 */
 	virtual std::unique_ptr<value> clone() const = 0;
 
+	/** Make a copy of this BSON value, in a given buffer if it will fit.
+	 * This allows bson::any to hold small values without allocating
+	 * memory. The default implementation always allocates the copy on
+	 * the heap. Types which override it to construct the copy within
+	 * the buffer must not throw when doing so.
+	 * @param storage a buffer for the copy, aligned as for int64_t
+	 * @param size the size of the buffer, in octets
+	 * @return a pointer to the copy, which is either within the buffer
+	 *  or allocated on the heap
+	 */
+	virtual value* clone_into(void* storage, size_t size) const;
+
 	/** Get the type code for this value.
 	 * @return the type code
 	 */
@@ -55,6 +80,13 @@ public:
 	 */
 	virtual std::string to_json() const = 0;
 
+	/** Send this value to an emitter.
+	 * Within a document the caller is responsible for emitting the key
+	 * before calling this function.
+	 * @param em the emitter to receive the value
+	 */
+	virtual void emit(emitter& em) const = 0;
+
 	/** Resolve the underlying value.
 	 * If this value is a reference to another value (as in the case of a
 	 * bson::any) then return a reference to that underlying value,
@@ -96,19 +128,31 @@ public:
 	 */
 	virtual operator octet::string() const;
 
-	/** Dynamically cast this object to a sepcific type of bson::value.
+	/** Cast this object to a specific type of bson::value.
 	 * If this value is a reference to another value (as in the case of a
 	 * bson::any) then return a cast reference to that underlying value,
 	 * otherwise return a cast reference to this.
+	 *
+	 * For the concrete BSON types, which each have a distinct type code,
+	 * the check is made by comparing type codes rather than by using
+	 * dynamic_cast. Other types fall back to dynamic_cast.
 	 * @return a cast reference to the underlying value
 	 * @throws std::bad_cast if the value is not of the expected type
 	 */
 	template<class T>
 	T& as() {
-		return dynamic_cast<T&>(**this);
+		if constexpr (has_type_code<T>) {
+			value& v = **this;
+			if (v.type() != T::type_code) {
+				throw std::bad_cast();
+			}
+			return static_cast<T&>(v);
+		} else {
+			return dynamic_cast<T&>(**this);
+		}
 	}
 
-	/** Dynamically cast this object to a sepcific type of bson::value.
+	/** Cast this object to a specific type of bson::value.
 	 * If this value is a reference to another value (as in the case of a
 	 * bson::any) then return a cast reference to that underlying value,
 	 * otherwise return a cast reference to this.
@@ -117,15 +161,27 @@ public:
 	 */
 	template<class T>
 	const T& as() const {
-		return dynamic_cast<const T&>(**this);
+		if constexpr (has_type_code<T>) {
+			const value& v = **this;
+			if (v.type() != T::type_code) {
+				throw std::bad_cast();
+			}
+			return static_cast<const T&>(v);
+		} else {
+			return dynamic_cast<const T&>(**this);
+		}
 	}
 
-	/** Test whether this object can be dynamically cast to a given type
+	/** Test whether this object can be cast to a given type.
 	 * @return true if it can be cast, otherwise false
 	 */
 	template<class T>
 	bool is() const {
-		return dynamic_cast<const T*>(&**this);
+		if constexpr (has_type_code<T>) {
+			return (**this).type() == T::type_code;
+		} else {
+			return dynamic_cast<const T*>(&**this);
+		}
 	}
 
 	/** Get the single member corresponding to a given name.
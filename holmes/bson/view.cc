@@ -0,0 +1,280 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <cstring>
+#include <stdexcept>
+#include <typeinfo>
+
+#include "holmes/bson/emitter.h"
+#include "holmes/bson/view.h"
+
+namespace holmes::bson {
+
+/** Get the encoded length of a BSON value from its leading octets.
+ * Only the length field (if any) is inspected.
+ * @param type the BSON type code
+ * @param bd the BSON data, starting with the value
+ * @return the encoded length of the value, in octets
+ * @throws std::invalid_argument if the type is not supported or the
+ *  length field is invalid
+ */
+static size_t encoded_length(unsigned char type, const octet::string& bd) {
+	switch (type) {
+	case 0x02:
+		{
+			int32_t length = get_int32(bd, 0, -1);
+			if (length < 1) {
+				throw std::invalid_argument("invalid length in BSON string");
+			}
+			return static_cast<size_t>(length) + 4;
+		}
+	case 0x03:
+		{
+			int32_t length = get_int32(bd, 0, -1);
+			if (length < 5) {
+				throw std::invalid_argument(
+					"invalid length in BSON document");
+			}
+			return length;
+		}
+	case 0x04:
+		{
+			int32_t length = get_int32(bd, 0, -1);
+			if (length < 5) {
+				throw std::invalid_argument("invalid length in BSON array");
+			}
+			return length;
+		}
+	case 0x05:
+		{
+			int32_t length = get_int32(bd, 0, -1);
+			if (length < 0) {
+				throw std::invalid_argument(
+					"invalid length in BSON binary data");
+			}
+			return static_cast<size_t>(length) + 5;
+		}
+	case 0x08:
+		return 1;
+	case 0x0a:
+		return 0;
+	case 0x10:
+		return 4;
+	case 0x12:
+		return 8;
+	default:
+		throw std::invalid_argument("unsupported BSON type code");
+	}
+}
+
+view::view(octet::string& bd):
+	view(0x03, bd) {}
+
+view::view(unsigned char type, octet::string& bd):
+	_type(type) {
+
+	size_t length = encoded_length(type, bd);
+	if (length > bd.length()) {
+		throw std::invalid_argument("truncated BSON value");
+	}
+	_data = read(bd, length);
+
+	switch (type) {
+	case 0x02:
+		if (_data[length - 1] != 0) {
+			throw std::invalid_argument("missing terminator in BSON string");
+		}
+		break;
+	case 0x03:
+		if (_data[length - 1] != 0) {
+			throw std::invalid_argument(
+				"missing terminator in BSON document");
+		}
+		break;
+	case 0x04:
+		if (_data[length - 1] != 0) {
+			throw std::invalid_argument("missing terminator in BSON array");
+		}
+		break;
+	}
+}
+
+octet::string view::_content() const {
+	if ((_type != 0x03) && (_type != 0x04)) {
+		throw std::runtime_error("BSON value is not a document or array");
+	}
+	return _data.substr(4, _data.length() - 5);
+}
+
+view::operator bool() const {
+	if (_type != 0x08) {
+		throw std::bad_cast();
+	}
+	unsigned char value = _data[0];
+	if ((value & ~1) != 0) {
+		throw std::invalid_argument("invalid encoding for BSON boolean");
+	}
+	return value;
+}
+
+view::operator int64_t() const {
+	switch (_type) {
+	case 0x10:
+		return get_int32(_data, 0, -1);
+	case 0x12:
+		return get_int64(_data, 0, -1);
+	default:
+		throw std::bad_cast();
+	}
+}
+
+view::operator std::string_view() const {
+	if (_type != 0x02) {
+		throw std::bad_cast();
+	}
+	return std::string_view(
+		reinterpret_cast<const char*>(_data.data() + 4),
+		_data.length() - 5);
+}
+
+view::operator octet::string() const {
+	if (_type != 0x05) {
+		throw std::bad_cast();
+	}
+	if (_data[4] != 0) {
+		throw std::invalid_argument(
+			"unsupported subtype in BSON binary data");
+	}
+	return _data.substr(5);
+}
+
+view::iterator view::begin() const {
+	return iterator(_content());
+}
+
+view::iterator view::end() const {
+	return iterator();
+}
+
+std::optional<view> view::find(std::string_view name) const {
+	if (_type != 0x03) {
+		throw std::runtime_error(
+			"BSON value does not support indexing by string");
+	}
+	for (const member& m : *this) {
+		if (m.name() == name) {
+			return m.value();
+		}
+	}
+	return std::nullopt;
+}
+
+view view::at(std::string_view name) const {
+	if (_type != 0x03) {
+		throw std::runtime_error(
+			"BSON value does not support indexing by string");
+	}
+	std::optional<view> found;
+	for (const member& m : *this) {
+		if (m.name() == name) {
+			if (found) {
+				throw std::out_of_range("out of range");
+			} else {
+				found = m.value();
+			}
+		}
+	}
+	if (!found) {
+		throw std::out_of_range("out of range");
+	}
+	return *found;
+}
+
+view view::at(size_t index) const {
+	if (_type != 0x04) {
+		throw std::runtime_error(
+			"BSON value does not support indexing by integer");
+	}
+	for (const member& m : *this) {
+		if (index-- == 0) {
+			return m.value();
+		}
+	}
+	throw std::out_of_range("out of range");
+}
+
+any view::materialise() const {
+	octet::string bd = _data;
+	return any(_type, bd);
+}
+
+void view::emit(emitter& em) const {
+	switch (_type) {
+	case 0x02:
+		em.string(static_cast<std::string_view>(*this));
+		break;
+	case 0x03:
+		em.begin_document();
+		for (const member& m : *this) {
+			if (em.key(m.name())) {
+				m.value().emit(em);
+			}
+		}
+		em.end_document();
+		break;
+	case 0x04:
+		em.begin_array();
+		for (const member& m : *this) {
+			m.value().emit(em);
+		}
+		em.end_array();
+		break;
+	case 0x05:
+		em.binary(static_cast<octet::string>(*this));
+		break;
+	case 0x08:
+		em.boolean(static_cast<bool>(*this));
+		break;
+	case 0x0a:
+		em.null();
+		break;
+	case 0x10:
+		em.int32(static_cast<int64_t>(*this));
+		break;
+	case 0x12:
+		em.int64(static_cast<int64_t>(*this));
+		break;
+	}
+}
+
+view::iterator::iterator(const octet::string& content):
+	_rest(content) {
+
+	_advance();
+}
+
+void view::iterator::_advance() {
+	if (_rest.empty()) {
+		_current.reset();
+		return;
+	}
+	unsigned char type = read_uint8(_rest);
+	if (type == 0) {
+		_rest.remove_prefix(_rest.length());
+		_current.reset();
+		return;
+	}
+	auto f = static_cast<const unsigned char*>(
+		std::memchr(_rest.data(), 0, _rest.length()));
+	if (!f) {
+		throw std::invalid_argument("missing terminator in BSON key");
+	}
+	size_t count = f - _rest.data();
+	std::string_view name(reinterpret_cast<const char*>(_rest.data()), count);
+	_rest.remove_prefix(count + 1);
+	_current.emplace(name, view(type, _rest));
+}
+
+} /* namespace holmes::bson */
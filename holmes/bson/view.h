@@ -0,0 +1,262 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_BSON_VIEW
+#define HOLMES_BSON_VIEW
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string_view>
+
+#include "holmes/octet/string.h"
+#include "holmes/bson/any.h"
+
+namespace holmes::bson {
+
+class emitter;
+
+/** A class to give read-only access to an encoded BSON value in place.
+ * Unlike decoding into a tree of bson::value objects, no keys or strings
+ * are copied and no memory is allocated. Members of a document or array
+ * are located by scanning the encoded data each time they are needed,
+ * and each is checked only as far as is necessary to step over it.
+ * A value can be decoded into a tree on request, using materialise().
+ *
+ * A view refers to the same underlying buffer as the octet string from
+ * which it was constructed, so remains valid for as long as it exists.
+ */
+class view {
+public:
+	class member;
+	class iterator;
+private:
+	/** The BSON type code. */
+	unsigned char _type;
+
+	/** The encoded value, excluding the type code and key. */
+	octet::string _data;
+
+	/** Get the encoded members of a document or array.
+	 * This excludes the leading length field and the trailing terminator.
+	 * @return the encoded members
+	 * @throws std::runtime_error if this is not a document or array
+	 */
+	octet::string _content() const;
+public:
+	/** Construct view of a BSON document.
+	 * The octet string is advanced past the end of the document, so that
+	 * consecutive documents can be read from a stream.
+	 * @param bd the BSON data to be viewed
+	 * @throws std::invalid_argument if the document length is invalid
+	 */
+	explicit view(octet::string& bd);
+
+	/** Construct view of a BSON value of a given type.
+	 * The octet string is advanced past the end of the value.
+	 * @param type the BSON type code
+	 * @param bd the BSON data to be viewed
+	 * @throws std::invalid_argument if the type is not supported or the
+	 *  encoded length is invalid
+	 */
+	view(unsigned char type, octet::string& bd);
+
+	/** Get the type code for this value.
+	 * @return the type code
+	 */
+	unsigned char type() const {
+		return _type;
+	}
+
+	/** Get the encoded content of this value.
+	 * This excludes the type code and key.
+	 * @return the encoded content
+	 */
+	const octet::string& data() const {
+		return _data;
+	}
+
+	/** Get the encoded length of this value.
+	 * @return the length, in octets
+	 */
+	size_t length() const {
+		return _data.length();
+	}
+
+	/** Test whether this value is null.
+	 * @return true if null, otherwise false
+	 */
+	bool is_null() const {
+		return _type == 0x0a;
+	}
+
+	/** Get the content of this BSON value if it is a boolean.
+	 * @return the content
+	 * @throws std::bad_cast if this is not a boolean
+	 */
+	explicit operator bool() const;
+
+	/** Get the content of this BSON value if it is an integer.
+	 * Allowed types are int32 and int64.
+	 * @return the content
+	 * @throws std::bad_cast if this is not an integer type
+	 */
+	operator int64_t() const;
+
+	/** Get the content of this BSON value if it is a character string.
+	 * The result refers to the underlying buffer.
+	 * @return the content
+	 * @throws std::bad_cast if this is not a character string
+	 */
+	operator std::string_view() const;
+
+	/** Get the content of this BSON value if it is a binary string.
+	 * The result refers to the underlying buffer.
+	 * @return the content
+	 * @throws std::bad_cast if this is not a binary string
+	 */
+	operator octet::string() const;
+
+	/** Get an iterator to the first member of a document or array.
+	 * @return the iterator
+	 * @throws std::runtime_error if this is not a document or array
+	 */
+	iterator begin() const;
+
+	/** Get an iterator to one past the last member of a document or array.
+	 * @return the iterator
+	 */
+	iterator end() const;
+
+	/** Find the first member of a document with a given name.
+	 * @param name the name of the member
+	 * @return the value of the member, or std::nullopt if not found
+	 * @throws std::runtime_error if this is not a document
+	 */
+	std::optional<view> find(std::string_view name) const;
+
+	/** Get the single member corresponding to a given name.
+	 * @param name the name of the member
+	 * @return the value of the member
+	 * @throws std::out_of_range unless there is exactly one match
+	 * @throws std::runtime_error if this is not a document
+	 */
+	view at(std::string_view name) const;
+
+	/** Get the member of an array with a given index.
+	 * @param index the index of the member
+	 * @return the value of the member
+	 * @throws std::out_of_range if there is no member with that index
+	 * @throws std::runtime_error if this is not an array
+	 */
+	view at(size_t index) const;
+
+	/** Decode this value into a tree of bson::value objects.
+	 * @return the decoded value
+	 */
+	any materialise() const;
+
+	/** Send this value to an emitter.
+	 * Within a document the caller is responsible for emitting the key
+	 * before calling this function. Members rejected by the emitter are
+	 * skipped without being decoded.
+	 * @param em the emitter to receive the value
+	 */
+	void emit(emitter& em) const;
+};
+
+/** A class to represent a member of a viewed document or array. */
+class view::member {
+private:
+	/** The name of the member. */
+	std::string_view _name;
+
+	/** The value of the member. */
+	view _value;
+public:
+	/** Construct member.
+	 * @param name the name of the member
+	 * @param value the value of the member
+	 */
+	member(std::string_view name, const view& value):
+		_name(name),
+		_value(value) {}
+
+	/** Get the name of this member.
+	 * For an array this is the index, formatted as a decimal string.
+	 * The result refers to the underlying buffer.
+	 * @return the name
+	 */
+	std::string_view name() const {
+		return _name;
+	}
+
+	/** Get the value of this member.
+	 * @return the value
+	 */
+	const view& value() const {
+		return _value;
+	}
+};
+
+/** A class for iterating over the members of a viewed document or array.
+ * Each member is located when the iterator is advanced to it.
+ */
+class view::iterator {
+public:
+	typedef std::input_iterator_tag iterator_category;
+	typedef view::member value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef const view::member* pointer;
+	typedef const view::member& reference;
+private:
+	/** The encoded members which follow the current one. */
+	octet::string _rest;
+
+	/** The current member, or std::nullopt if at the end. */
+	std::optional<member> _current;
+
+	/** Locate the next member, if there is one. */
+	void _advance();
+public:
+	/** Construct iterator at end. */
+	iterator() = default;
+
+	/** Construct iterator at the first member of some encoded content.
+	 * @param content the encoded members
+	 */
+	explicit iterator(const octet::string& content);
+
+	reference operator*() const {
+		return *_current;
+	}
+
+	pointer operator->() const {
+		return &*_current;
+	}
+
+	iterator& operator++() {
+		_advance();
+		return *this;
+	}
+
+	iterator operator++(int) {
+		iterator result = *this;
+		_advance();
+		return result;
+	}
+
+	bool operator==(const iterator& that) const {
+		if (!_current || !that._current) {
+			return !_current && !that._current;
+		}
+		return _rest.length() == that._rest.length();
+	}
+};
+
+} /* namespace holmes::bson */
+
+#endif
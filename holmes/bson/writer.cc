@@ -10,28 +10,32 @@
 
 namespace holmes::bson {
 
-unsigned char* writer::write(size_t count) {
-	if (_remaining < count) {
-		throw std::out_of_range("BSON buffer full");
+unsigned char* writer::patch(size_t offset, size_t count) {
+	if ((offset > _buffer.size()) || (count > _buffer.size() - offset)) {
+		throw std::out_of_range("BSON patch out of range");
 	}
-	auto buffer = _ptr;
-	_ptr += count;
-	_remaining -= count;
-	return buffer;
+	return _buffer.data() + offset;
 }
 
 void write_uint8(writer& bw, uint8_t value) {
 	bw.write(1)[0] = value;
 }
 
-void write_int32(writer& bw, int32_t value) {
-	auto buffer = bw.write(4);
+/** Encode a signed 32-bit integer in little-endian byte order.
+ * @param buffer the buffer to receive the encoded integer
+ * @param value the value to be encoded
+ */
+static void encode_int32(unsigned char* buffer, int32_t value) {
 	buffer[0] = value >> 0;
 	buffer[1] = value >> 8;
 	buffer[2] = value >> 16;
 	buffer[3] = value >> 24;
 }
 
+void write_int32(writer& bw, int32_t value) {
+	encode_int32(bw.write(4), value);
+}
+
 void write_int64(writer& bw, int64_t value) {
 	auto buffer = bw.write(8);
 	buffer[0] = value >> 0;
@@ -55,4 +59,14 @@ void write_cstring(writer& bw, const char* value) {
 	std::memcpy(buffer, value, len + 1);
 }
 
+void write_cstring(writer& bw, std::string_view value) {
+	auto buffer = bw.write(value.length() + 1);
+	std::memcpy(buffer, value.data(), value.length());
+	buffer[value.length()] = 0;
+}
+
+void patch_int32(writer& bw, size_t offset, int32_t value) {
+	encode_int32(bw.patch(offset, 4), value);
+}
+
 } /* namespace holmes::bson */
@@ -8,31 +8,72 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string_view>
+#include <vector>
 
 namespace holmes::bson {
 
-/** A class for writing BSON data to a buffer. */
+/** A class for writing BSON data to a buffer.
+ * The buffer grows as needed. Since the length of a document or array is
+ * not known until its content has been written, space for the length is
+ * reserved beforehand and filled in afterwards using patch(). This allows
+ * a value to be encoded in a single pass, without first calculating the
+ * length of each nested document. The buffer can be cleared and reused,
+ * in which case its capacity is retained.
+ */
 class writer {
 private:
-	/** A pointer to the next octet to be written. */
-	unsigned char* _ptr;
-
-	/** The number of octets remaining. */
-	size_t _remaining;
+	/** The content written so far. */
+	std::vector<unsigned char> _buffer;
 public:
-	/** Construct BSON writer.
-	 * @param buffer the buffer to be written into
-	 * @param size the size of the buffer, in octets
-	 */
-	writer(unsigned char* buffer, size_t size):
-		_ptr(buffer),
-		_remaining(size) {}
-
 	/** Write a given number of octets.
+	 * The returned pointer is invalidated by any subsequent write.
 	 * @param count the number of octets to be written
 	 * @return a pointer to a buffer for receiving the octets
 	 */
-	unsigned char* write(size_t count);
+	unsigned char* write(size_t count) {
+		size_t offset = _buffer.size();
+		_buffer.resize(offset + count);
+		return _buffer.data() + offset;
+	}
+
+	/** Overwrite octets which have already been written.
+	 * The returned pointer is invalidated by any subsequent write.
+	 * @param offset the offset of the first octet to be overwritten
+	 * @param count the number of octets to be overwritten
+	 * @return a pointer to a buffer for receiving the octets
+	 * @throws std::out_of_range if the octets have not been written
+	 */
+	unsigned char* patch(size_t offset, size_t count);
+
+	/** Get the content written so far.
+	 * @return a pointer to the content
+	 */
+	const unsigned char* data() const {
+		return _buffer.data();
+	}
+
+	/** Get the number of octets written so far.
+	 * This is also the offset at which the next octet will be written.
+	 * @return the number of octets
+	 */
+	size_t size() const {
+		return _buffer.size();
+	}
+
+	/** Discard any content beyond a given length.
+	 * @param size the number of octets to be retained
+	 */
+	void truncate(size_t size) {
+		if (size < _buffer.size()) {
+			_buffer.resize(size);
+		}
+	}
+
+	/** Discard the content written so far. */
+	void clear() {
+		_buffer.clear();
+	}
 };
 
 /* Write an unsigned 8-bit integer to a bson::writer.
@@ -66,6 +107,19 @@ void write(writer& bw, const void* data, size_t count);
  */
 void write_cstring(writer& bw, const char* value);
 
+/** Write a string followed by a null terminator to a bson::writer.
+ * @param bw the bson::writer to receive the data
+ * @param value the value to be written
+ */
+void write_cstring(writer& bw, std::string_view value);
+
+/** Overwrite a signed 32-bit integer which has already been written.
+ * @param bw the bson::writer containing the data
+ * @param offset the offset of the integer
+ * @param value the value to be written
+ */
+void patch_int32(writer& bw, size_t offset, int32_t value);
+
 } /* namespace holmes::bson */
 
 #endif
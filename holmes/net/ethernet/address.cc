@@ -3,7 +3,7 @@
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
-#include <sstream>
+#include <cstring>
 #include <iomanip>
 
 #include "holmes/parse_error.h"
@@ -11,29 +11,55 @@
 
 namespace holmes::net::ethernet {
 
-address::address(octet::string& raw):
-	_raw(read(raw, _length)) {
+namespace {
 
-	if (_raw.length() != _length) {
+/** The upper case hexadecimal digits. */
+constexpr char hex_digits[] = "0123456789ABCDEF";
+
+} /* anonymous namespace */
+
+address::address(octet::string& raw) {
+	octet::string data = read(raw, length);
+	if (data.length() != length) {
 		throw parse_error("Ethernet address must be 6 octets long");
 	}
+	std::memcpy(_octets.data(), data.data(), length);
 }
 
 address::operator std::string() const {
-	std::ostringstream out;
-	out << std::uppercase << *this;
-	return out.str();
+	char buffer[max_chars];
+	auto result = to_chars(buffer, buffer + max_chars, *this);
+	return std::string(buffer, result.ptr);
+}
+
+std::to_chars_result to_chars(char* first, char* last, const address& addr) {
+	if (static_cast<size_t>(last - first) < address::max_chars) {
+		return {last, std::errc::value_too_large};
+	}
+	const unsigned char* data = addr.data();
+	for (unsigned int i = 0; i != address::length; ++i) {
+		if (i != 0) {
+			*first++ = '-';
+		}
+		*first++ = hex_digits[data[i] >> 4];
+		*first++ = hex_digits[data[i] & 0xf];
+	}
+	return {first, std::errc()};
 }
 
 std::ostream& operator<<(std::ostream& out, const address& addr) {
-	auto raw = addr.raw();
-	size_t len = raw.length();
-	for (unsigned int i = 0; i != len; ++i) {
+	std::ios_base::fmtflags flags(out.flags());
+	char fill = out.fill('0');
+	out << std::hex;
+	const unsigned char* data = addr.data();
+	for (unsigned int i = 0; i != address::length; ++i) {
 		if (i != 0) {
 			out << '-';
 		}
-		out << raw.substr(i, 1);
+		out << std::setw(2) << (data[i] & 0xff);
 	}
+	out.fill(fill);
+	out.flags(flags);
 	return out;
 }
 
@@ -6,6 +6,9 @@
 #ifndef HOLMES_NET_ETHERNET_ADDRESS
 #define HOLMES_NET_ETHERNET_ADDRESS
 
+#include <array>
+#include <charconv>
+#include <compare>
 #include <string>
 #include <iostream>
 
@@ -13,14 +16,20 @@
 
 namespace holmes::net::ethernet {
 
-/** A class to represent an Ethernet address. */
+/** A class to represent an Ethernet address.
+ * The address is held inline, so it can be constructed, copied and
+ * compared without any memory allocation.
+ */
 class address {
-private:
+public:
 	/** The length of an Ethernet address, in octets. */
-	static const size_t _length = 6;
+	static const size_t length = 6;
 
+	/** The length of an Ethernet address in IEEE format. */
+	static const size_t max_chars = 17;
+private:
 	/** The raw content of this address. */
-	octet::string _raw;
+	std::array<unsigned char, length> _octets;
 public:
 	/** Construct Ethernet address from raw content.
 	 * The content is removed from the start of the supplied octet string.
@@ -30,10 +39,17 @@ public:
 	explicit address(octet::string& raw);
 
 	/** Get the raw content of this address.
-	 * @return the raw content
+	 * @return a pointer to the first octet
 	 */
-	const octet::string& raw() const {
-		return _raw;
+	const unsigned char* data() const {
+		return _octets.data();
+	}
+
+	/** Get the length of this address.
+	 * @return the length, in octets
+	 */
+	static constexpr size_t size() {
+		return length;
 	}
 
 	/** Convert this Ethernet address to a string, in IEEE format.
@@ -42,9 +58,26 @@ public:
 	 * transmission order, separated by hyphens.
 	 * @return the address as a string
 	 */
-	virtual operator std::string() const;
+	operator std::string() const;
+
+	friend bool operator==(const address&, const address&) = default;
+	friend std::strong_ordering operator<=>(const address&,
+		const address&) = default;
 };
 
+/** Write an Ethernet address to a character buffer in IEEE format.
+ * The format is the same as for operator ethernet::address::std::string().
+ * This follows the conventions of std::to_chars: no terminating null is
+ * written, and if the buffer is too small then the result has an error
+ * code of std::errc::value_too_large and a pointer equal to last.
+ * @param first a pointer to the start of the buffer
+ * @param last a pointer to the end of the buffer
+ * @param addr the Ethernet address
+ * @return a pointer to one past the last character written, and an
+ *  error code
+ */
+std::to_chars_result to_chars(char* first, char* last, const address& addr);
+
 /** Write an Ethernet address to an output stream in IEEE format.
  * The format is the same as for operator ethernet::address::std::string(),
  * except that where there is a choice between upper and lower case this is
@@ -3,20 +3,27 @@
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
-#include "holmes/bson/int32.h"
-#include "holmes/bson/string.h"
-#include "holmes/bson/binary.h"
 #include "holmes/net/ethernet/frame.h"
 
 namespace holmes::net::ethernet {
 
-bson::document frame::to_bson() const {
-	bson::document bson_frame;
-	bson_frame.append("dst_addr", bson::string(dst_addr()));
-	bson_frame.append("src_addr", bson::string(src_addr()));
-	bson_frame.append("ethertype", bson::int32(ethertype()));
-	bson_frame.append("payload", bson::binary(payload()));
-	return bson_frame;
+using namespace bson::literals;
+
+void frame::emit(bson::emitter& em) const {
+	em.begin_document();
+	if (em.key("dst_addr"_key)) {
+		em.formatted(dst_addr());
+	}
+	if (em.key("src_addr"_key)) {
+		em.formatted(src_addr());
+	}
+	if (em.key("ethertype"_key)) {
+		em.int32(ethertype());
+	}
+	if (em.key("payload"_key)) {
+		em.binary(payload());
+	}
+	em.end_document();
 }
 
 } /* namespace holmes::net::ethernet */
@@ -6,7 +6,6 @@
 #ifndef HOLMES_NET_ETHERNET_FRAME
 #define HOLMES_NET_ETHERNET_FRAME
 
-#include <memory>
 #include <cstdint>
 
 #include "holmes/octet/string.h"
@@ -21,12 +20,6 @@ class frame:
 private:
 	/** The raw content of this frame. */
 	octet::string _data;
-
-	/** The destination address. */
-	mutable std::unique_ptr<address> _dst_addr;
-
-	/** The source address. */
-	mutable std::unique_ptr<address> _src_addr;
 public:
 	/** Construct ethernet frame.
 	 * The raw content should include the header and the payload,
@@ -39,23 +32,17 @@ public:
 	/** Get the destination address.
 	 * @return the destination address
 	 */
-	const address& dst_addr() const {
-		if (!_dst_addr) {
-			auto dst_addr_data = _data.substr(0, 6);
-			_dst_addr = std::make_unique<address>(dst_addr_data);
-		}
-		return *_dst_addr;
+	address dst_addr() const {
+		auto dst_addr_data = _data.substr(0, 6);
+		return address(dst_addr_data);
 	}
 
 	/** Get the source address.
 	 * @return the source address
 	 */
-	const address& src_addr() const {
-		if (!_src_addr) {
-			auto src_addr_data = _data.substr(6, 6);
-			_src_addr = std::make_unique<address>(src_addr_data);
-		}
-		return *_src_addr;
+	address src_addr() const {
+		auto src_addr_data = _data.substr(6, 6);
+		return address(src_addr_data);
 	}
 
 	/** Get the ethertype.
@@ -74,7 +61,7 @@ public:
 		return _data.substr(14);
 	}
 
-	bson::document to_bson() const override;
+	void emit(bson::emitter& em) const override;
 };
 
 } /* namespace holmes::net::ethernet */
@@ -0,0 +1,525 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <limits>
+
+#include <arpa/inet.h>
+
+#include "holmes/parse_error.h"
+#include "holmes/net/filter.h"
+
+namespace holmes::net {
+
+namespace {
+
+/** The offset of the ethertype within an Ethernet frame. */
+const size_t ethertype_offset = 12;
+
+/** The offset of the network layer header within an Ethernet frame. */
+const size_t inet_offset = 14;
+
+/** A structure to represent a node in the syntax tree of a filter. */
+struct node {
+	/** An enumeration of node types. */
+	enum class kind { test, conjunction, disjunction, negation };
+
+	/** The type of this node. */
+	kind type;
+
+	/** The test to be performed, if this is a test node. */
+	filter::instruction insn;
+
+	/** The left-hand or only operand, if this is an operator node. */
+	std::unique_ptr<node> lhs;
+
+	/** The right-hand operand, if this is a binary operator node. */
+	std::unique_ptr<node> rhs;
+};
+
+/** Make a test node.
+ * @param op the test to be performed
+ * @param k the first operand
+ * @param mask the second operand
+ * @return the resulting node
+ */
+std::unique_ptr<node> make_test(filter::opcode op, uint32_t k,
+	uint32_t mask = 0) {
+
+	auto result = std::make_unique<node>();
+	result->type = node::kind::test;
+	result->insn = filter::instruction{op, k, mask, 0, 0};
+	return result;
+}
+
+/** Make an operator node.
+ * @param type the type of operator
+ * @param lhs the left-hand or only operand
+ * @param rhs the right-hand operand, if any
+ * @return the resulting node
+ */
+std::unique_ptr<node> make_operator(node::kind type,
+	std::unique_ptr<node> lhs, std::unique_ptr<node> rhs = nullptr) {
+
+	auto result = std::make_unique<node>();
+	result->type = type;
+	result->lhs = std::move(lhs);
+	result->rhs = std::move(rhs);
+	return result;
+}
+
+/** A class for parsing filter expressions into a syntax tree. */
+class parser {
+private:
+	/** The tokens which make up the expression. */
+	std::vector<std::string> _tokens;
+
+	/** The index of the next token to be parsed. */
+	size_t _index = 0;
+
+	/** A table for accumulating any IPv6 networks. */
+	std::vector<filter::inet6_network>* _inet6_networks;
+
+	/** Peek at the next token.
+	 * @return the next token, or the empty string if none
+	 */
+	const std::string& _peek() const {
+		static const std::string none;
+		return (_index < _tokens.size()) ? _tokens[_index] : none;
+	}
+
+	/** Read the next token.
+	 * @param what a description of what is expected, for error reporting
+	 * @return the token
+	 */
+	const std::string& _next(const char* what) {
+		if (_index == _tokens.size()) {
+			throw parse_error(std::string("expected ") + what +
+				" in filter expression");
+		}
+		return _tokens[_index++];
+	}
+
+	/** Parse a disjunction.
+	 * @return the resulting syntax tree
+	 */
+	std::unique_ptr<node> _parse_or();
+
+	/** Parse a conjunction.
+	 * @return the resulting syntax tree
+	 */
+	std::unique_ptr<node> _parse_and();
+
+	/** Parse a negation, parenthesised expression or primitive.
+	 * @return the resulting syntax tree
+	 */
+	std::unique_ptr<node> _parse_unary();
+
+	/** Parse a primitive.
+	 * @return the resulting syntax tree
+	 */
+	std::unique_ptr<node> _parse_primitive();
+
+	/** Parse a host or network address.
+	 * @param qualifier the direction qualifier ("src", "dst" or empty)
+	 * @param require_prefix true if a prefix length is required
+	 * @return the resulting syntax tree
+	 */
+	std::unique_ptr<node> _parse_address(const std::string& qualifier,
+		bool require_prefix);
+public:
+	/** Construct parser.
+	 * @param expr the expression to be parsed
+	 * @param inet6_networks a table for accumulating IPv6 networks
+	 */
+	parser(const std::string& expr,
+		std::vector<filter::inet6_network>& inet6_networks);
+
+	/** Parse the expression.
+	 * @return the resulting syntax tree, or null if the expression is empty
+	 */
+	std::unique_ptr<node> operator()();
+};
+
+parser::parser(const std::string& expr,
+	std::vector<filter::inet6_network>& inet6_networks):
+	_inet6_networks(&inet6_networks) {
+
+	size_t i = 0;
+	while (i != expr.length()) {
+		char c = expr[i];
+		if (std::isspace(static_cast<unsigned char>(c))) {
+			i += 1;
+		} else if ((c == '(') || (c == ')')) {
+			_tokens.push_back(std::string(1, c));
+			i += 1;
+		} else if (c == '!') {
+			_tokens.push_back("not");
+			i += 1;
+		} else if (expr.compare(i, 2, "&&") == 0) {
+			_tokens.push_back("and");
+			i += 2;
+		} else if (expr.compare(i, 2, "||") == 0) {
+			_tokens.push_back("or");
+			i += 2;
+		} else {
+			size_t j = i;
+			while ((j != expr.length()) &&
+				!std::isspace(static_cast<unsigned char>(expr[j])) &&
+				!std::strchr("()!&|", expr[j])) {
+				j += 1;
+			}
+			if (j == i) {
+				throw parse_error("unexpected character in filter expression");
+			}
+			_tokens.push_back(expr.substr(i, j - i));
+			i = j;
+		}
+	}
+}
+
+std::unique_ptr<node> parser::operator()() {
+	if (_tokens.empty()) {
+		return nullptr;
+	}
+	auto result = _parse_or();
+	if (_index != _tokens.size()) {
+		throw parse_error("unexpected '" + _tokens[_index] +
+			"' in filter expression");
+	}
+	return result;
+}
+
+std::unique_ptr<node> parser::_parse_or() {
+	auto result = _parse_and();
+	while (_peek() == "or") {
+		_index += 1;
+		result = make_operator(node::kind::disjunction,
+			std::move(result), _parse_and());
+	}
+	return result;
+}
+
+std::unique_ptr<node> parser::_parse_and() {
+	auto result = _parse_unary();
+	while (true) {
+		const std::string& token = _peek();
+		if (token == "and") {
+			_index += 1;
+		} else if (token.empty() || (token == "or") || (token == ")")) {
+			break;
+		}
+		result = make_operator(node::kind::conjunction,
+			std::move(result), _parse_unary());
+	}
+	return result;
+}
+
+std::unique_ptr<node> parser::_parse_unary() {
+	const std::string& token = _next("primitive");
+	if (token == "not") {
+		return make_operator(node::kind::negation, _parse_unary());
+	} else if (token == "(") {
+		auto result = _parse_or();
+		if (_next("')'") != ")") {
+			throw parse_error("expected ')' in filter expression");
+		}
+		return result;
+	}
+	_index -= 1;
+	return _parse_primitive();
+}
+
+/** Parse an unsigned integer.
+ * @param token the token to be parsed
+ * @param limit the maximum permitted value
+ * @return the resulting value
+ */
+uint32_t parse_number(const std::string& token, uint32_t limit) {
+	if (token.empty() || (token.find_first_not_of("0123456789") !=
+		std::string::npos) || (token.length() > 10)) {
+
+		throw parse_error("invalid number '" + token +
+			"' in filter expression");
+	}
+	unsigned long value = std::stoul(token);
+	if (value > limit) {
+		throw parse_error("number '" + token +
+			"' out of range in filter expression");
+	}
+	return value;
+}
+
+std::unique_ptr<node> parser::_parse_primitive() {
+	std::string qualifier;
+	if ((_peek() == "src") || (_peek() == "dst")) {
+		qualifier = _next("primitive");
+	}
+
+	const std::string& token = _next("primitive");
+	if (token == "host") {
+		return _parse_address(qualifier, false);
+	} else if (token == "net") {
+		return _parse_address(qualifier, true);
+	} else if (token == "port") {
+		uint32_t port = parse_number(_next("port number"), 0xffff);
+		if (qualifier == "src") {
+			return make_test(filter::opcode::src_port, port);
+		} else if (qualifier == "dst") {
+			return make_test(filter::opcode::dst_port, port);
+		}
+		return make_operator(node::kind::disjunction,
+			make_test(filter::opcode::src_port, port),
+			make_test(filter::opcode::dst_port, port));
+	} else if (!qualifier.empty()) {
+		throw parse_error("expected host, net or port after '" + qualifier +
+			"' in filter expression");
+	} else if (token == "ip") {
+		return make_test(filter::opcode::ethertype, 0x0800);
+	} else if (token == "ip6") {
+		return make_test(filter::opcode::ethertype, 0x86dd);
+	} else if (token == "arp") {
+		return make_test(filter::opcode::ethertype, 0x0806);
+	} else if (token == "icmp") {
+		return make_test(filter::opcode::protocol, 1);
+	} else if (token == "tcp") {
+		return make_test(filter::opcode::protocol, 6);
+	} else if (token == "udp") {
+		return make_test(filter::opcode::protocol, 17);
+	} else if (token == "icmp6") {
+		return make_test(filter::opcode::protocol, 58);
+	} else if (token == "proto") {
+		return make_test(filter::opcode::protocol,
+			parse_number(_next("protocol number"), 0xff));
+	}
+	throw parse_error("unrecognised primitive '" + token +
+		"' in filter expression");
+}
+
+std::unique_ptr<node> parser::_parse_address(const std::string& qualifier,
+	bool require_prefix) {
+
+	std::string token = _next("address");
+	std::string addr_str = token;
+	std::string prefix_str;
+	size_t slash = token.find('/');
+	if (slash != std::string::npos) {
+		addr_str = token.substr(0, slash);
+		prefix_str = token.substr(slash + 1);
+	} else if (require_prefix) {
+		throw parse_error("missing prefix length for net '" + token +
+			"' in filter expression");
+	}
+
+	std::unique_ptr<node> src_test;
+	std::unique_ptr<node> dst_test;
+	unsigned char addr[16];
+	if (inet_pton(AF_INET, addr_str.c_str(), addr) == 1) {
+		unsigned int prefix_length = (prefix_str.empty()) ? 32 :
+			parse_number(prefix_str, 32);
+		uint32_t mask = (prefix_length == 0) ? 0 :
+			0xffffffff << (32 - prefix_length);
+		uint32_t value = (addr[0] << 24) | (addr[1] << 16) |
+			(addr[2] << 8) | addr[3];
+		src_test = make_test(filter::opcode::inet4_src, value & mask, mask);
+		dst_test = make_test(filter::opcode::inet4_dst, value & mask, mask);
+	} else if (inet_pton(AF_INET6, addr_str.c_str(), addr) == 1) {
+		filter::inet6_network network;
+		network.prefix_length = (prefix_str.empty()) ? 128 :
+			parse_number(prefix_str, 128);
+		for (unsigned int i = 0; i != 16; ++i) {
+			unsigned int bits = std::min(8U, std::max(8 * i,
+				network.prefix_length) - 8 * i);
+			network.addr[i] = addr[i] & ~(0xff >> bits);
+		}
+		uint32_t index = _inet6_networks->size();
+		_inet6_networks->push_back(network);
+		src_test = make_test(filter::opcode::inet6_src, index);
+		dst_test = make_test(filter::opcode::inet6_dst, index);
+	} else {
+		throw parse_error("invalid address '" + addr_str +
+			"' in filter expression");
+	}
+
+	if (qualifier == "src") {
+		return src_test;
+	} else if (qualifier == "dst") {
+		return dst_test;
+	}
+	return make_operator(node::kind::disjunction,
+		std::move(src_test), std::move(dst_test));
+}
+
+/** A structure to represent an instruction in a reversed program.
+ * Jump targets are expressed as indices into the reversed program, with
+ * the accept and reject targets given by the values -1 and -2.
+ */
+struct reversed_instruction {
+	/** The instruction, excluding its jump targets. */
+	filter::instruction insn;
+
+	/** The reversed index of the next instruction if the test succeeds. */
+	long jt;
+
+	/** The reversed index of the next instruction if the test fails. */
+	long jf;
+};
+
+/** Compile a syntax tree into a program.
+ * The program is generated in reverse order, so that the jump targets of
+ * each instruction are already known at the point when it is emitted.
+ * The entry point of the compiled tree is always the last instruction to
+ * have been emitted.
+ * @param n the syntax tree to be compiled
+ * @param jt the target if the tree evaluates to true
+ * @param jf the target if the tree evaluates to false
+ * @param rprogram the reversed program to be appended to
+ * @return the reversed index of the entry point of the compiled tree
+ */
+long compile(const node& n, long jt, long jf,
+	std::vector<reversed_instruction>& rprogram) {
+
+	switch (n.type) {
+	case node::kind::test:
+		rprogram.push_back(reversed_instruction{n.insn, jt, jf});
+		return rprogram.size() - 1;
+	case node::kind::conjunction:
+		return compile(*n.lhs, compile(*n.rhs, jt, jf, rprogram), jf,
+			rprogram);
+	case node::kind::disjunction:
+		return compile(*n.lhs, jt, compile(*n.rhs, jt, jf, rprogram),
+			rprogram);
+	case node::kind::negation:
+		return compile(*n.lhs, jf, jt, rprogram);
+	}
+	throw std::logic_error("unexpected node type in filter expression");
+}
+
+} /* anonymous namespace */
+
+filter::filter(const std::string& expr) {
+	parser p(expr, _inet6_networks);
+	auto tree = p();
+	if (!tree) {
+		return;
+	}
+
+	std::vector<reversed_instruction> rprogram;
+	compile(*tree, -1, -2, rprogram);
+	if (rprogram.size() + 1 > std::numeric_limits<uint16_t>::max()) {
+		throw parse_error("filter expression too long");
+	}
+
+	// Reverse the program. The same mapping converts the accept and reject
+	// targets to the length of the program and one greater than that.
+	long count = rprogram.size();
+	_program.reserve(count);
+	for (auto i = rprogram.rbegin(); i != rprogram.rend(); ++i) {
+		instruction insn = i->insn;
+		insn.jt = count - 1 - i->jt;
+		insn.jf = count - 1 - i->jf;
+		_program.push_back(insn);
+	}
+}
+
+bool filter::_test(const instruction& insn, const unsigned char* data,
+	size_t length) const {
+
+	if (length < inet_offset) {
+		return false;
+	}
+	uint16_t ethertype = (data[ethertype_offset] << 8) |
+		data[ethertype_offset + 1];
+	const unsigned char* ip = data + inet_offset;
+	size_t ip_length = length - inet_offset;
+
+	switch (insn.op) {
+	case opcode::ethertype:
+		return ethertype == insn.k;
+	case opcode::protocol:
+		if ((ethertype == 0x0800) && (ip_length >= 20)) {
+			return ip[9] == insn.k;
+		} else if ((ethertype == 0x86dd) && (ip_length >= 40)) {
+			return ip[6] == insn.k;
+		}
+		return false;
+	case opcode::inet4_src:
+	case opcode::inet4_dst:
+		if ((ethertype == 0x0800) && (ip_length >= 20)) {
+			const unsigned char* addr = ip +
+				((insn.op == opcode::inet4_src) ? 12 : 16);
+			uint32_t value = (addr[0] << 24) | (addr[1] << 16) |
+				(addr[2] << 8) | addr[3];
+			return (value & insn.mask) == insn.k;
+		}
+		return false;
+	case opcode::inet6_src:
+	case opcode::inet6_dst:
+		if ((ethertype == 0x86dd) && (ip_length >= 40)) {
+			const unsigned char* addr = ip +
+				((insn.op == opcode::inet6_src) ? 8 : 24);
+			const inet6_network& network = _inet6_networks[insn.k];
+			unsigned int whole = network.prefix_length / 8;
+			unsigned int part = network.prefix_length % 8;
+			if (std::memcmp(addr, network.addr.data(), whole) != 0) {
+				return false;
+			}
+			if (part != 0) {
+				unsigned char mask = ~(0xff >> part);
+				return (addr[whole] & mask) == network.addr[whole];
+			}
+			return true;
+		}
+		return false;
+	case opcode::src_port:
+	case opcode::dst_port:
+		{
+			uint8_t protocol;
+			size_t l4_offset;
+			if ((ethertype == 0x0800) && (ip_length >= 20)) {
+				// Only the first fragment contains a transport layer
+				// header.
+				if ((((ip[6] << 8) | ip[7]) & 0x1fff) != 0) {
+					return false;
+				}
+				protocol = ip[9];
+				l4_offset = (ip[0] & 0xf) * 4;
+			} else if ((ethertype == 0x86dd) && (ip_length >= 40)) {
+				protocol = ip[6];
+				l4_offset = 40;
+			} else {
+				return false;
+			}
+			if ((protocol != 6) && (protocol != 17) && (protocol != 132)) {
+				return false;
+			}
+			size_t port_offset = l4_offset +
+				((insn.op == opcode::src_port) ? 0 : 2);
+			if (ip_length < port_offset + 2) {
+				return false;
+			}
+			uint16_t port = (ip[port_offset] << 8) | ip[port_offset + 1];
+			return port == insn.k;
+		}
+	}
+	return false;
+}
+
+bool filter::operator()(const octet::string& frame) const {
+	const unsigned char* data = frame.data();
+	size_t length = frame.length();
+	size_t count = _program.size();
+	size_t pc = 0;
+	while (pc < count) {
+		const instruction& insn = _program[pc];
+		pc = _test(insn, data, length) ? insn.jt : insn.jf;
+	}
+	return pc == count;
+}
+
+} /* namespace holmes::net */
@@ -0,0 +1,134 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_NET_FILTER
+#define HOLMES_NET_FILTER
+
+#include <cstdint>
+#include <array>
+#include <string>
+#include <vector>
+
+#include "holmes/octet/string.h"
+
+namespace holmes::net {
+
+/** A class to represent a compiled packet filter.
+ * Filter expressions are written in a subset of the pcap-filter language.
+ * The following primitives are recognised:
+ *
+ * - "ip", "ip6", "arp": match the ethertype
+ * - "tcp", "udp", "icmp", "icmp6": match the IP protocol number
+ * - "proto <n>": match an arbitrary IP protocol number
+ * - "[src|dst] host <addr>[/<len>]": match an IPv4 or IPv6 address
+ * - "[src|dst] net <addr>/<len>": match an IPv4 or IPv6 network
+ * - "[src|dst] port <n>": match a TCP, UDP or SCTP port number
+ *
+ * Primitives can be combined using "and" (or "&&"), "or" (or "||"),
+ * "not" (or "!") and parentheses. Adjacent primitives with no operator
+ * between them are treated as if joined by "and". Where neither "src" nor
+ * "dst" is given, either will match.
+ *
+ * The expression is compiled into a flat program of test instructions,
+ * each with a pair of forward jump targets, which is evaluated directly
+ * against the raw content of an Ethernet frame. Each instruction reads
+ * the fixed header offsets that it needs, and fails (rather than throws)
+ * if the frame is too short or of the wrong type. No artefact objects
+ * are constructed, so the cost of rejecting a packet is limited to the
+ * handful of header fields needed to reach that decision.
+ */
+class filter {
+public:
+	/** An enumeration of the tests which can be performed. */
+	enum class opcode: uint8_t {
+		/** Test whether the ethertype is equal to k. */
+		ethertype,
+		/** Test whether the IPv4 or IPv6 protocol is equal to k. */
+		protocol,
+		/** Test whether the IPv4 source address, masked, is equal to k. */
+		inet4_src,
+		/** Test whether the IPv4 destination address, masked, is equal to k. */
+		inet4_dst,
+		/** Test whether the IPv6 source address matches network k. */
+		inet6_src,
+		/** Test whether the IPv6 destination address matches network k. */
+		inet6_dst,
+		/** Test whether the transport layer source port is equal to k. */
+		src_port,
+		/** Test whether the transport layer destination port is equal to k. */
+		dst_port
+	};
+
+	/** A structure to represent a single test instruction.
+	 * Jump targets are absolute indices into the program, and are always
+	 * greater than the index of the instruction itself. A target equal to
+	 * the length of the program means accept, and one greater than that
+	 * means reject.
+	 */
+	struct instruction {
+		/** The test to be performed. */
+		opcode op;
+
+		/** The first operand: a value to compare against, or for IPv6
+		 * networks, an index into the table of IPv6 networks. */
+		uint32_t k;
+
+		/** The second operand: a mask to apply, where applicable. */
+		uint32_t mask;
+
+		/** The index of the next instruction if the test succeeds. */
+		uint16_t jt;
+
+		/** The index of the next instruction if the test fails. */
+		uint16_t jf;
+	};
+
+	/** A structure to represent an IPv6 network. */
+	struct inet6_network {
+		/** The network address, with host bits cleared. */
+		std::array<unsigned char, 16> addr;
+
+		/** The prefix length, in bits. */
+		unsigned int prefix_length;
+	};
+private:
+	/** The compiled program. */
+	std::vector<instruction> _program;
+
+	/** The IPv6 networks referred to by the program. */
+	std::vector<inet6_network> _inet6_networks;
+
+	/** Perform a single test.
+	 * @param insn the instruction to be performed
+	 * @param data the raw content of the frame
+	 * @param length the length of the frame, in octets
+	 * @return the result of the test
+	 */
+	bool _test(const instruction& insn, const unsigned char* data,
+		size_t length) const;
+public:
+	/** Compile a filter expression.
+	 * @param expr the filter expression
+	 * @throws parse_error if the expression is not valid
+	 */
+	explicit filter(const std::string& expr);
+
+	/** Get the compiled program.
+	 * @return the program
+	 */
+	const std::vector<instruction>& program() const {
+		return _program;
+	}
+
+	/** Test whether an Ethernet frame is accepted by this filter.
+	 * @param frame the raw content of the frame
+	 * @return true if accepted, otherwise false
+	 */
+	bool operator()(const octet::string& frame) const;
+};
+
+} /* namespace holmes::net */
+
+#endif
@@ -22,6 +22,8 @@ namespace holmes::net::icmp::echo {
  */
 class message:
 	public icmp::message {
+protected:
+	void _emit_members(bson::emitter& em) const override;
 public:
 	/** Construct ICMP echo message.
 	 * @param data the raw content
@@ -49,8 +51,6 @@ public:
 	octet::string payload() const {
 		return data().substr(8);
 	}
-
-	bson::document to_bson() const override;
 };
 
 } /* namespace holmes::net::icmp::echo */
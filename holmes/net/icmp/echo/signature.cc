@@ -1,5 +1,5 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
@@ -28,6 +28,24 @@ signature::signature(const bson::document& bson_sig) {
 	}
 }
 
+signature::signature(const bson::view& bson_sig) {
+	try {
+		_id = static_cast<int64_t>(bson_sig.at("id"));
+	} catch (std::out_of_range&) {
+		// No action: optional field
+	}
+	try {
+		_seqnum = static_cast<int64_t>(bson_sig.at("seqnum"));
+	} catch (std::out_of_range&) {
+		// No action: optional field
+	}
+	try {
+		_payload = octet::pattern::any(bson_sig.at("payload").materialise());
+	} catch (std::out_of_range&) {
+		// No action: optional field
+	}
+}
+
 bool signature::operator()(const icmp::echo::message& msg) const {
 	if (_id) {
 		if (msg.id() != *_id) {
@@ -1,5 +1,5 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
@@ -9,6 +9,7 @@
 #include <optional>
 
 #include "holmes/octet/pattern/any.h"
+#include "holmes/bson/view.h"
 #include "holmes/net/icmp/echo/message.h"
 
 namespace holmes::net::icmp::echo {
@@ -30,6 +31,12 @@ public:
 	 */
 	explicit signature(const bson::document& bson_sig);
 
+	/** Construct ICMP echo signature from a view of encoded BSON.
+	 * Only the payload pattern, if there is one, is decoded into a tree.
+	 * @param bson_sig the signature as a view of encoded BSON
+	 */
+	explicit signature(const bson::view& bson_sig);
+
 	/** Test whether a given ICMP echo message matches this signature.
 	 * @param msg the message to be tested
 	 * @return true if signature matched, otherwise false
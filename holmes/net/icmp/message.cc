@@ -3,14 +3,14 @@
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
-#include "holmes/bson/int32.h"
-#include "holmes/bson/binary.h"
 #include "holmes/net/inet/checksum.h"
 #include "holmes/net/icmp/message.h"
 #include "holmes/net/icmp/echo/message.h"
 
 namespace holmes::net::icmp {
 
+using namespace bson::literals;
+
 uint16_t message::calculated_checksum() const {
 	inet::checksum checksum;
 	checksum(_data.substr(0, 2));
@@ -18,17 +18,32 @@ uint16_t message::calculated_checksum() const {
 	return checksum;
 }
 
-bson::document message::to_bson() const {
-	bson::document bson_checksum;
-	bson_checksum.append("recorded", bson::int32(recorded_checksum()));
-	bson_checksum.append("calculated", bson::int32(calculated_checksum()));
-
-	bson::document bson_message;
-	bson_message.append("type", bson::int32(type()));
-	bson_message.append("code", bson::int32(code()));
-	bson_message.append("checksum", bson_checksum);
-	bson_message.append("raw_payload", bson::binary(raw_payload()));
-	return bson_message;
+void message::_emit_members(bson::emitter& em) const {
+	if (em.key("type"_key)) {
+		em.int32(type());
+	}
+	if (em.key("code"_key)) {
+		em.int32(code());
+	}
+	if (em.key("checksum"_key)) {
+		em.begin_document();
+		if (em.key("recorded"_key)) {
+			em.int32(recorded_checksum());
+		}
+		if (em.key("calculated"_key)) {
+			em.int32(calculated_checksum());
+		}
+		em.end_document();
+	}
+	if (em.key("raw_payload"_key)) {
+		em.binary(raw_payload());
+	}
+}
+
+void message::emit(bson::emitter& em) const {
+	em.begin_document();
+	_emit_members(em);
+	em.end_document();
 }
 
 std::unique_ptr<message> message::parse_icmp4(const octet::string& data) {
@@ -21,6 +21,12 @@ class message:
 private:
 	/** The raw content. */
 	octet::string _data;
+protected:
+	/** Emit the members of the BSON description of this message.
+	 * Subclasses which add members should call this function first.
+	 * @param em the emitter to receive the members
+	 */
+	virtual void _emit_members(bson::emitter& em) const;
 public:
 	/** Construct ICMP message.
 	 * @param data the raw content
@@ -70,7 +76,7 @@ public:
 		return _data.substr(4);
 	}
 
-	bson::document to_bson() const override;
+	void emit(bson::emitter& em) const override;
 
 	/** Parse an ICMPv4 option.
 	 * @param data a source of raw content
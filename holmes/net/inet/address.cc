@@ -0,0 +1,23 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include "holmes/parse_error.h"
+#include "holmes/net/inet4/address.h"
+#include "holmes/net/inet6/address.h"
+
+namespace holmes::net::inet {
+
+std::unique_ptr<address> address::make(const address_value& value) {
+	switch (value.version()) {
+	case 4:
+		return std::make_unique<inet4::address>(value.as_inet4());
+	case 6:
+		return std::make_unique<inet6::address>(value.as_inet6());
+	default:
+		throw parse_error("IP address must be 4 or 16 octets long");
+	}
+}
+
+} /* namespace holmes::net::inet */
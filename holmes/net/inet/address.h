@@ -7,10 +7,14 @@
 #define HOLMES_NET_INET_ADDRESS
 
 #include "holmes/net/address.h"
+#include "holmes/net/inet/address_value.h"
 
 namespace holmes::net::inet {
 
-/** A class to represent an IP address. */
+/** A class to represent an IP address.
+ * This is a polymorphic adaptor, for use where an address is required to
+ * be an artefact. Elsewhere, inet::address_value should be preferred.
+ */
 class address:
 	public net::address {
 protected:
@@ -28,6 +32,19 @@ public:
 	std::unique_ptr<address> clone() const {
 		return std::unique_ptr<address>(_clone());
 	}
+
+	/** Get the value of this address.
+	 * @return the address value
+	 */
+	address_value value() const {
+		return address_value(data());
+	}
+
+	/** Make an IP address adaptor from an address value.
+	 * @param value the address value
+	 * @return the resulting IPv4 or IPv6 address
+	 */
+	static std::unique_ptr<address> make(const address_value& value);
 };
 
 inline bool operator==(const address& lhs, const address& rhs) {
@@ -0,0 +1,80 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <cstring>
+#include <algorithm>
+
+#include "holmes/parse_error.h"
+#include "holmes/net/inet/address_value.h"
+
+namespace holmes::net::inet {
+
+address_value::address_value(const inet4::address_value& addr):
+	_octets{},
+	_length(inet4::address_value::length) {
+
+	std::memcpy(_octets.data(), addr.data(), _length);
+}
+
+address_value::address_value(const inet6::address_value& addr):
+	_length(inet6::address_value::length) {
+
+	std::memcpy(_octets.data(), addr.data(), _length);
+}
+
+address_value::address_value(const octet::string& data):
+	_octets{},
+	_length(data.length()) {
+
+	if ((data.length() != inet4::address_value::length) &&
+		(data.length() != inet6::address_value::length)) {
+		throw parse_error("IP address must be 4 or 16 octets long");
+	}
+	std::memcpy(_octets.data(), data.data(), _length);
+}
+
+address_value::operator std::string() const {
+	char buffer[max_chars];
+	auto result = to_chars(buffer, buffer + max_chars, *this);
+	return std::string(buffer, result.ptr);
+}
+
+std::strong_ordering operator<=>(const address_value& lhs,
+	const address_value& rhs) {
+
+	size_t common_length = std::min(lhs.size(), rhs.size());
+	int result = std::memcmp(lhs.data(), rhs.data(), common_length);
+	if (result != 0) {
+		return result <=> 0;
+	}
+	return lhs.size() <=> rhs.size();
+}
+
+std::to_chars_result to_chars(char* first, char* last,
+	const address_value& addr) {
+
+	switch (addr.size()) {
+	case inet4::address_value::length:
+		return inet4::to_chars(first, last, addr.as_inet4());
+	case inet6::address_value::length:
+		return inet6::to_chars(first, last, addr.as_inet6());
+	default:
+		return {first, std::errc()};
+	}
+}
+
+std::ostream& operator<<(std::ostream& out, const address_value& addr) {
+	switch (addr.size()) {
+	case inet4::address_value::length:
+		out << addr.as_inet4();
+		break;
+	case inet6::address_value::length:
+		out << addr.as_inet6();
+		break;
+	}
+	return out;
+}
+
+} /* namespace holmes::net::inet */
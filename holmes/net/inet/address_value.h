@@ -0,0 +1,140 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_NET_INET_ADDRESS_VALUE
+#define HOLMES_NET_INET_ADDRESS_VALUE
+
+#include <cstdint>
+#include <array>
+#include <charconv>
+#include <compare>
+#include <string>
+#include <iostream>
+
+#include "holmes/octet/string.h"
+#include "holmes/net/inet4/address_value.h"
+#include "holmes/net/inet6/address_value.h"
+
+namespace holmes::net::inet {
+
+/** A class to represent an IPv4 or IPv6 address by value.
+ * The address is held inline, with room for the longer of the two
+ * address types, so it can be constructed, copied and compared without
+ * any memory allocation or virtual function calls.
+ *
+ * Addresses are ordered lexicographically by octet, with any address
+ * which is a prefix of another ordered first. (This matches the ordering
+ * of the raw content as octet strings.)
+ */
+class address_value {
+private:
+	/** The raw content of this address, padded with zeros. */
+	std::array<unsigned char, inet6::address_value::length> _octets;
+
+	/** The length of this address, in octets. */
+	uint8_t _length;
+public:
+	/** The maximum length of an IP address in canonical form. */
+	static const size_t max_chars = inet6::address_value::max_chars;
+
+	/** Construct empty address. */
+	address_value():
+		_octets{},
+		_length(0) {}
+
+	/** Construct IP address from an IPv4 address.
+	 * @param addr the IPv4 address
+	 */
+	address_value(const inet4::address_value& addr);
+
+	/** Construct IP address from an IPv6 address.
+	 * @param addr the IPv6 address
+	 */
+	address_value(const inet6::address_value& addr);
+
+	/** Construct IP address from raw content.
+	 * @param data the required raw content
+	 * @throws parse_error if the content is not 4 or 16 octets long
+	 */
+	explicit address_value(const octet::string& data);
+
+	/** Get the raw content of this address.
+	 * @return a pointer to the first octet
+	 */
+	const unsigned char* data() const {
+		return _octets.data();
+	}
+
+	/** Get the length of this address.
+	 * @return the length, in octets
+	 */
+	size_t size() const {
+		return _length;
+	}
+
+	/** Get the IP version number of this address.
+	 * @return 4 or 6, or 0 if empty
+	 */
+	unsigned int version() const {
+		switch (_length) {
+		case inet4::address_value::length:
+			return 4;
+		case inet6::address_value::length:
+			return 6;
+		default:
+			return 0;
+		}
+	}
+
+	/** Convert this address to an IPv4 address.
+	 * The result is unspecified unless this is an IPv4 address.
+	 * @return the IPv4 address
+	 */
+	inet4::address_value as_inet4() const {
+		return inet4::address_value(data());
+	}
+
+	/** Convert this address to an IPv6 address.
+	 * The result is unspecified unless this is an IPv6 address.
+	 * @return the IPv6 address
+	 */
+	inet6::address_value as_inet6() const {
+		return inet6::address_value(data());
+	}
+
+	/** Convert this address to a string, in canonical form.
+	 * @return the address as a string
+	 */
+	operator std::string() const;
+
+	friend bool operator==(const address_value&,
+		const address_value&) = default;
+	friend std::strong_ordering operator<=>(const address_value& lhs,
+		const address_value& rhs);
+};
+
+/** Write an IP address to a character buffer in canonical form.
+ * The format and error handling are as for the corresponding IPv4 or
+ * IPv6 address type. Nothing is written for an empty address.
+ * @param first a pointer to the start of the buffer
+ * @param last a pointer to the end of the buffer
+ * @param addr the IP address
+ * @return a pointer to one past the last character written, and an
+ *  error code
+ */
+std::to_chars_result to_chars(char* first, char* last,
+	const address_value& addr);
+
+/** Write an IP address to an output stream in canonical form.
+ * The format is as for the corresponding IPv4 or IPv6 address type.
+ * @param out the output stream
+ * @param addr the IP address
+ * @return the output stream
+ */
+std::ostream& operator<<(std::ostream& out, const address_value& addr);
+
+} /* namespace holmes::net::inet */
+
+#endif
@@ -0,0 +1,81 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_NET_INET_CONNECTION_INFO
+#define HOLMES_NET_INET_CONNECTION_INFO
+
+#include <algorithm>
+#include <cstdint>
+
+#include "holmes/net/inet/flow_info.h"
+
+namespace holmes::net::inet {
+
+/** A class for recording information about a bidirectional connection.
+ * A connection is identified by the canonical form of its 5-tuple (see
+ * five_tuple::canonical()). Traffic which matches that 5-tuple is in
+ * the forward direction, and traffic which matches its reverse is in
+ * the reverse direction. Separate flow information is kept for each.
+ */
+class connection_info {
+private:
+	/** The flow information for each direction.
+	 * This is indexed by the direction bit: 0 for forward, 1 for
+	 * reverse.
+	 */
+	flow_info _flows[2];
+public:
+	/** Get the flow information for one direction.
+	 * @param reverse true for the reverse direction, false for forward
+	 * @return the flow information
+	 */
+	flow_info& flow(bool reverse) {
+		return _flows[reverse];
+	}
+
+	/** Get the flow information for one direction.
+	 * @param reverse true for the reverse direction, false for forward
+	 * @return the flow information
+	 */
+	const flow_info& flow(bool reverse) const {
+		return _flows[reverse];
+	}
+
+	/** Get the TCP state of this connection.
+	 * This is derived from the states of the two endpoints.
+	 * @return the TCP state
+	 */
+	tcp_state state() const {
+		tcp_state fwd = _flows[0].state();
+		tcp_state rev = _flows[1].state();
+		if (fwd == tcp_state::reset || rev == tcp_state::reset) {
+			return tcp_state::reset;
+		}
+		if (fwd == tcp_state::fin_wait && rev == tcp_state::fin_wait) {
+			return tcp_state::closed;
+		}
+		return std::max(fwd, rev);
+	}
+
+	/** Test whether this connection has been closed or reset.
+	 * @return true if closed or reset, otherwise false
+	 */
+	bool closed() const {
+		tcp_state s = state();
+		return s == tcp_state::closed || s == tcp_state::reset;
+	}
+
+	/** Get the time at which the last packet was observed in either
+	 * direction.
+	 * @return the timestamp, in microseconds since the Unix epoch
+	 */
+	int64_t last() const {
+		return std::max(_flows[0].last(), _flows[1].last());
+	}
+};
+
+} /* namespace holmes::net::inet */
+
+#endif
@@ -7,13 +7,12 @@
 #define HOLMES_NET_INET_DATAGRAM
 
 #include "holmes/artefact.h"
+#include "holmes/net/inet/address_value.h"
 #include "holmes/net/inet/checksum.h"
 #include "holmes/net/inet/wrapper.h"
 
 namespace holmes::net::inet {
 
-class address;
-
 /** An abstract base class to represent an IP datagram. */
 class datagram:
 	public artefact,
@@ -37,12 +36,12 @@ public:
 	/** Get the source address.
 	 * @return the source address
 	 */
-	virtual const address& src_addr() const = 0;
+	virtual address_value src_addr() const = 0;
 
 	/** Get the destination address.
 	 * @return the destination address
 	 */
-	virtual const address& dst_addr() const = 0;
+	virtual address_value dst_addr() const = 0;
 
 	/** Make checksum for pseudo-header.
 	 * @param protocol the transport protocol number
@@ -3,7 +3,7 @@
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
-#include <sstream>
+#include <cstring>
 
 #include "holmes/bson/int32.h"
 #include "holmes/bson/string.h"
@@ -12,28 +12,25 @@
 
 namespace holmes::net::inet {
 
-five_tuple::five_tuple(uint8_t protocol, inet::address& dst_addr,
-	uint16_t dst_port, inet::address& src_addr, uint16_t src_port):
-	_protocol(protocol),
-	_dst_addr(dst_addr.clone()),
-	_dst_port(dst_port),
-	_src_addr(src_addr.clone()),
-	_src_port(src_port) {}
-
 five_tuple::five_tuple(const inet::datagram& inet_dgram,
 	const inet::l4_packet& l4_pkt):
 	_protocol(inet_dgram.protocol()),
-	_dst_addr(inet_dgram.dst_addr().clone()),
+	_dst_addr(inet_dgram.dst_addr()),
 	_dst_port(l4_pkt.dst_port()),
-	_src_addr(inet_dgram.src_addr().clone()),
+	_src_addr(inet_dgram.src_addr()),
 	_src_port(l4_pkt.src_port()) {}
 
 five_tuple::operator std::string() const {
-	std::stringstream out;
-	out << int(protocol()) << ";"
-		<< src_addr() << ":" << src_port() << "=>"
-		<< dst_addr() << ":" << dst_port();
-	return out.str();
+	char buffer[max_chars];
+	auto result = to_chars(buffer, buffer + max_chars, *this);
+	return std::string(buffer, result.ptr);
+}
+
+bool five_tuple::canonical() const {
+	if (_dst_addr != _src_addr) {
+		return _dst_addr < _src_addr;
+	}
+	return _dst_port <= _src_port;
 }
 
 bson::document five_tuple::to_bson() const {
@@ -46,6 +43,30 @@ bson::document five_tuple::to_bson() const {
 	return bson_five_tuple;
 }
 
+std::to_chars_result to_chars(char* first, char* last,
+	const five_tuple& tuple) {
+
+	char buffer[five_tuple::max_chars];
+	char* end = buffer + five_tuple::max_chars;
+	char* ptr = std::to_chars(buffer, end, tuple.protocol()).ptr;
+	*ptr++ = ';';
+	ptr = to_chars(ptr, end, tuple.src_addr()).ptr;
+	*ptr++ = ':';
+	ptr = std::to_chars(ptr, end, tuple.src_port()).ptr;
+	*ptr++ = '=';
+	*ptr++ = '>';
+	ptr = to_chars(ptr, end, tuple.dst_addr()).ptr;
+	*ptr++ = ':';
+	ptr = std::to_chars(ptr, end, tuple.dst_port()).ptr;
+
+	size_t count = ptr - buffer;
+	if (static_cast<size_t>(last - first) < count) {
+		return {last, std::errc::value_too_large};
+	}
+	std::memcpy(first, buffer, count);
+	return {first + count, std::errc()};
+}
+
 bool operator==(const five_tuple& lhs, const five_tuple& rhs) {
 	if (lhs.protocol() != rhs.protocol()) {
 		return false;
@@ -6,12 +6,12 @@
 #ifndef HOLMES_NET_INET_FIVE_TUPLE
 #define HOLMES_NET_INET_FIVE_TUPLE
 
+#include <charconv>
 #include <compare>
-#include <memory>
 #include <ostream>
 
 #include "holmes/bson/document.h"
-#include "holmes/net/inet/address.h"
+#include "holmes/net/inet/address_value.h"
 #include "holmes/net/inet/datagram.h"
 #include "holmes/net/inet/l4_packet.h"
 
@@ -36,17 +36,21 @@ private:
 	uint8_t _protocol;
 
 	/** The destination IP address. */
-	std::unique_ptr<inet::address> _dst_addr;
+	inet::address_value _dst_addr;
 
 	/** The destination port number. */
 	uint16_t _dst_port;
 
 	/** The source IP address. */
-	std::unique_ptr<inet::address> _src_addr;
+	inet::address_value _src_addr;
 
 	/** The source port number. */
 	uint16_t _src_port;
 public:
+	/** The maximum length of a 5-tuple in string form. */
+	static const size_t max_chars = 3 + 1 + inet::address_value::max_chars +
+		1 + 5 + 2 + inet::address_value::max_chars + 1 + 5;
+
 	/** Construct 5-tuple from components.
 	 * @param protocol the protocol number
 	 * @param dst_addr the destination address
@@ -54,8 +58,14 @@ public:
 	 * @param src_addr the source address
 	 * @param src_port the source port number
 	 */
-	five_tuple(uint8_t protocol, inet::address& dst_addr, uint16_t dst_port,
-		inet::address& src_addr, uint16_t src_port);
+	five_tuple(uint8_t protocol, const inet::address_value& dst_addr,
+		uint16_t dst_port, const inet::address_value& src_addr,
+		uint16_t src_port):
+		_protocol(protocol),
+		_dst_addr(dst_addr),
+		_dst_port(dst_port),
+		_src_addr(src_addr),
+		_src_port(src_port) {}
 
 	/** Construct 5-tuple from network and transport layer packets.
 	 * @param inet_dgram the IP datagram
@@ -64,43 +74,6 @@ public:
 	five_tuple(const inet::datagram& inet_dgram,
 		const inet::l4_packet& l4_pkt);
 
-	five_tuple(const five_tuple& that):
-		_protocol(that._protocol),
-		_dst_addr(that._dst_addr->clone()),
-		_dst_port(that._dst_port),
-		_src_addr(that._src_addr->clone()),
-		_src_port(that._src_port) {}
-
-	five_tuple(five_tuple&& that):
-		_protocol(that._protocol),
-		_dst_addr(std::move(that._dst_addr)),
-		_dst_port(that._dst_port),
-		_src_addr(std::move(that._src_addr)),
-		_src_port(that._src_port) {}
-
-
-	five_tuple& operator=(const five_tuple& that) {
-		if (this != &that) {
-			_protocol = that._protocol;
-			_dst_addr = that._dst_addr->clone();
-			_dst_port = that._dst_port;
-			_src_addr = that._src_addr->clone();
-			_src_port = that._src_port;
-		}
-		return *this;
-	}
-
-	five_tuple& operator=(five_tuple&& that) {
-		if (this != &that) {
-			_protocol = that._protocol;
-			_dst_addr = std::move(that._dst_addr);
-			_dst_port = that._dst_port;
-			_src_addr = std::move(that._src_addr);
-			_src_port = that._src_port;
-		}
-		return *this;
-	}
-
 	/** Get the protocol number.
 	 * @return the protocol number
 	 */
@@ -111,8 +84,8 @@ public:
 	/** Get the destination IP address.
 	 * @return the destination address
 	 */
-	const inet::address& dst_addr() const {
-		return *_dst_addr;
+	const inet::address_value& dst_addr() const {
+		return _dst_addr;
 	}
 
 	/** Get the destination port number.
@@ -125,8 +98,8 @@ public:
 	/** Get the source IP address.
 	 * @return the source address
 	 */
-	const inet::address& src_addr() const {
-		return *_src_addr;
+	const inet::address_value& src_addr() const {
+		return _src_addr;
 	}
 
 	/** Get the source port number.
@@ -136,6 +109,30 @@ public:
 		return _src_port;
 	}
 
+	/** Get the reverse of this 5-tuple.
+	 * This is the 5-tuple for traffic flowing in the opposite direction,
+	 * with the source and destination endpoints interchanged.
+	 * @return the reversed 5-tuple
+	 */
+	five_tuple reverse() const {
+		return five_tuple(_protocol, _src_addr, _src_port,
+			_dst_addr, _dst_port);
+	}
+
+	/** Test whether this 5-tuple is in canonical form.
+	 * Of the two 5-tuples which describe the directions of a connection,
+	 * the canonical one is that for which the destination endpoint (by
+	 * address, then port number) is no greater than the source endpoint.
+	 * Exactly one of a 5-tuple and its reverse is canonical, unless the
+	 * endpoints are equal, in which case both are.
+	 * @return true if canonical, otherwise false
+	 */
+	bool canonical() const;
+
+	/** Convert this 5-tuple to a string.
+	 * The format is "<protocol>;<src_addr>:<src_port>=><dst_addr>:<dst_port>".
+	 * @return the 5-tuple as a string
+	 */
 	operator std::string() const;
 
 	/** Describe this 5-tuple using BSON.
@@ -144,6 +141,20 @@ public:
 	bson::document to_bson() const;
 };
 
+/** Write a 5-tuple to a character buffer.
+ * The format is as for operator five_tuple::std::string(). This follows
+ * the conventions of std::to_chars: no terminating null is written, and
+ * if the buffer is too small then the result has an error code of
+ * std::errc::value_too_large and a pointer equal to last.
+ * @param first a pointer to the start of the buffer
+ * @param last a pointer to the end of the buffer
+ * @param tuple the 5-tuple
+ * @return a pointer to one past the last character written, and an
+ *  error code
+ */
+std::to_chars_result to_chars(char* first, char* last,
+	const five_tuple& tuple);
+
 bool operator==(const five_tuple& lhs, const five_tuple& rhs);
 std::strong_ordering operator<=>(const five_tuple& lhs, const five_tuple& rhs);
 
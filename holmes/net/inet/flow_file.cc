@@ -0,0 +1,130 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <cstring>
+#include <stdexcept>
+
+#include "holmes/parse_error.h"
+#include "holmes/net/inet/flow_file.h"
+
+namespace holmes::net::inet {
+
+/** The flag bit for an active source. */
+static const uint8_t flag_active = 0x01;
+
+/** The flag bit for a passive source. */
+static const uint8_t flag_passive = 0x02;
+
+/** Encode an unsigned 16-bit integer in network byte order.
+ * @param buffer the buffer to receive the encoded integer
+ * @param value the value to be encoded
+ */
+static void encode_uint16(unsigned char* buffer, uint16_t value) {
+	buffer[0] = value >> 8;
+	buffer[1] = value >> 0;
+}
+
+/** Encode an unsigned 32-bit integer in network byte order.
+ * @param buffer the buffer to receive the encoded integer
+ * @param value the value to be encoded
+ */
+static void encode_uint32(unsigned char* buffer, uint32_t value) {
+	encode_uint16(buffer, value >> 16);
+	encode_uint16(buffer + 2, value);
+}
+
+/** Encode an unsigned 64-bit integer in network byte order.
+ * @param buffer the buffer to receive the encoded integer
+ * @param value the value to be encoded
+ */
+static void encode_uint64(unsigned char* buffer, uint64_t value) {
+	encode_uint32(buffer, value >> 32);
+	encode_uint32(buffer + 4, value);
+}
+
+/** Decode an IP address from a flow record.
+ * @param record the encoded record
+ * @param index the index of the address length field
+ * @param offset the offset of the address content
+ * @return the decoded address
+ */
+static address_value decode_address(const octet::string& record,
+	size_t index, size_t offset) {
+
+	size_t length = get_uint8(record, index);
+	return address_value(octet::string(record, offset, length));
+}
+
+flow_file::flow_file(const octet::string& content):
+	_content(content) {
+
+	if (read_uint32(_content) != magic_number) {
+		throw parse_error("invalid magic number in flow-record file");
+	}
+	if (read_uint16(_content) != version) {
+		throw parse_error("unsupported flow-record file version");
+	}
+	if (read_uint16(_content) != record_length) {
+		throw parse_error("invalid record length in flow-record file");
+	}
+	if (_content.length() % record_length) {
+		throw parse_error("truncated record in flow-record file");
+	}
+}
+
+flow_file::record_type flow_file::read() {
+	octet::string record = octet::read(_content, record_length);
+	uint8_t protocol = get_uint8(record, 0);
+	uint8_t flags = get_uint8(record, 1);
+	five_tuple key(protocol,
+		decode_address(record, 6, 8), get_uint16(record, 2),
+		decode_address(record, 7, 24), get_uint16(record, 4));
+	if (_last && !(*_last < key)) {
+		throw parse_error("records out of order in flow-record file");
+	}
+	_last = key;
+	return record_type(key,
+		flow_info(flags & flag_active, flags & flag_passive,
+			get_uint64(record, 40), get_uint64(record, 48),
+			get_int64(record, 56), get_int64(record, 64),
+			get_uint16(record, 72)));
+}
+
+flow_file_writer::flow_file_writer(std::ostream& out):
+	_out(&out) {
+
+	unsigned char header[flow_file::header_length];
+	encode_uint32(header, flow_file::magic_number);
+	encode_uint16(header + 4, flow_file::version);
+	encode_uint16(header + 6, flow_file::record_length);
+	_out->write(reinterpret_cast<const char*>(header), sizeof(header));
+}
+
+void flow_file_writer::write(const five_tuple& key, const flow_info& info) {
+	if (_last && !(*_last < key)) {
+		throw std::invalid_argument(
+			"flow records must be written in ascending order");
+	}
+	_last = key;
+
+	unsigned char record[flow_file::record_length] = {};
+	record[0] = key.protocol();
+	record[1] = (info.active() ? flag_active : 0) |
+		(info.passive() ? flag_passive : 0);
+	encode_uint16(record + 2, key.dst_port());
+	encode_uint16(record + 4, key.src_port());
+	record[6] = key.dst_addr().size();
+	record[7] = key.src_addr().size();
+	std::memcpy(record + 8, key.dst_addr().data(), key.dst_addr().size());
+	std::memcpy(record + 24, key.src_addr().data(), key.src_addr().size());
+	encode_uint64(record + 40, info.packets());
+	encode_uint64(record + 48, info.octets());
+	encode_uint64(record + 56, info.first());
+	encode_uint64(record + 64, info.last());
+	encode_uint16(record + 72, info.tcp_flags());
+	_out->write(reinterpret_cast<const char*>(record), sizeof(record));
+}
+
+} /* namespace holmes::net::inet */
@@ -0,0 +1,133 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_NET_INET_FLOW_FILE
+#define HOLMES_NET_INET_FLOW_FILE
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <utility>
+
+#include "holmes/octet/string.h"
+#include "holmes/net/inet/five_tuple.h"
+#include "holmes/net/inet/flow_info.h"
+
+namespace holmes::net::inet {
+
+/** A class to represent a binary flow-record file.
+ * The file consists of a fixed-length header followed by a sequence of
+ * fixed-width records, one per 5-tuple, in ascending order of 5-tuple
+ * with no duplicates. All integers are in network byte order.
+ *
+ * The header is:
+ * - the magic number 0x48464c57 ("HFLW") (4 octets)
+ * - the format version number (2 octets)
+ * - the record length (2 octets)
+ *
+ * Each record is:
+ * - the protocol number (1 octet)
+ * - flags: bit 0 = active, bit 1 = passive (1 octet)
+ * - the destination port number (2 octets)
+ * - the source port number (2 octets)
+ * - the destination address length (1 octet)
+ * - the source address length (1 octet)
+ * - the destination address, zero-padded (16 octets)
+ * - the source address, zero-padded (16 octets)
+ * - the number of packets (8 octets)
+ * - the number of octets, measured at the IP layer (8 octets)
+ * - the time of the first packet, in microseconds since the Unix epoch
+ *   (8 octets, signed)
+ * - the time of the last packet, in microseconds since the Unix epoch
+ *   (8 octets, signed)
+ * - the union of the TCP flags (2 octets)
+ * - reserved, zero (6 octets)
+ *
+ * Since the records are of fixed width and already sorted, a file can
+ * be read in place from a memory mapping (for example, an octet::file),
+ * and any number of files can be merged in a single streaming pass.
+ */
+class flow_file {
+public:
+	/** The magic number. */
+	static const uint32_t magic_number = 0x48464c57;
+
+	/** The format version number. */
+	static const uint16_t version = 2;
+
+	/** The length of the header, in octets. */
+	static const size_t header_length = 8;
+
+	/** The length of each record, in octets. */
+	static const size_t record_length = 80;
+
+	/** The type of a decoded record. */
+	typedef std::pair<five_tuple, flow_info> record_type;
+private:
+	/** The records which have not yet been read. */
+	octet::string _content;
+
+	/** The 5-tuple of the most recently read record, if any. */
+	std::optional<five_tuple> _last;
+public:
+	/** Construct flow-record file.
+	 * @param content the file content, as an octet string
+	 * @throws parse_error if the header is invalid, or the content is
+	 *  not a whole number of records
+	 */
+	explicit flow_file(const octet::string& content);
+
+	/** Get the number of records which have not yet been read.
+	 * @return the number of records
+	 */
+	size_t size() const {
+		return _content.length() / record_length;
+	}
+
+	/** Check whether the end of this file has been reached.
+	 * @return true if at end of file, otherwise false
+	 */
+	bool eof() const {
+		return _content.empty();
+	}
+
+	/** Read a record from this file.
+	 * @return the 5-tuple and flow information
+	 * @throws std::out_of_range if at end of file
+	 * @throws parse_error if the record is invalid or out of order
+	 */
+	record_type read();
+};
+
+/** A class for writing a binary flow-record file.
+ * The header is written on construction. Records must then be written
+ * in ascending order of 5-tuple, without duplicates.
+ */
+class flow_file_writer {
+private:
+	/** The stream to receive the output. */
+	std::ostream* _out;
+
+	/** The 5-tuple of the most recently written record, if any. */
+	std::optional<five_tuple> _last;
+public:
+	/** Construct flow-record file writer, and write the header.
+	 * @param out the stream to receive the output
+	 */
+	explicit flow_file_writer(std::ostream& out);
+
+	/** Write a record.
+	 * @param key the 5-tuple
+	 * @param info the flow information
+	 * @throws std::invalid_argument if the 5-tuple is not greater than
+	 *  that of the previous record
+	 */
+	void write(const five_tuple& key, const flow_info& info);
+};
+
+} /* namespace holmes::net::inet */
+
+#endif
@@ -3,14 +3,67 @@
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
+#include <algorithm>
+
 #include <holmes/net/inet/flow_info.h>
 
 namespace holmes::net::inet {
 
+/** The TCP FIN flag, as returned by tcp::segment::flags(). */
+static const uint16_t tcp_fin = 0x001;
+
+/** The TCP SYN flag, as returned by tcp::segment::flags(). */
+static const uint16_t tcp_syn = 0x002;
+
+/** The TCP RST flag, as returned by tcp::segment::flags(). */
+static const uint16_t tcp_rst = 0x004;
+
+/** The TCP ACK flag, as returned by tcp::segment::flags(). */
+static const uint16_t tcp_ack = 0x010;
+
+flow_info::flow_info(bool active, bool passive, uint64_t packets,
+	uint64_t octets, int64_t first, int64_t last, uint16_t tcp_flags):
+	_first(first) {
+
+	_hot.packets = packets;
+	_hot.octets = octets;
+	_hot.last = last;
+	_hot.tcp_flags = tcp_flags;
+	_hot.active = active;
+	_hot.passive = passive;
+}
+
 flow_info& flow_info::operator|=(const flow_info& info) {
-	_active |= info._active;
-	_passive |= info._passive;
+	mark(info._hot.active, info._hot.passive);
+	if (info._hot.packets != 0) {
+		if (_hot.packets == 0) {
+			_first = info._first;
+			_hot.last = info._hot.last;
+		} else {
+			_first = std::min(_first, info._first);
+			_hot.last = std::max(_hot.last, info._hot.last);
+		}
+		_hot.packets += info._hot.packets;
+		_hot.octets += info._hot.octets;
+		_hot.tcp_flags |= info._hot.tcp_flags;
+	}
 	return *this;
 }
 
+void flow_info::track(uint16_t tcp_flags) {
+	tcp_state& state = _hot.state;
+	if (tcp_flags & tcp_rst) {
+		state = tcp_state::reset;
+	} else if (tcp_flags & tcp_syn) {
+		state = (tcp_flags & tcp_ack) ?
+			tcp_state::syn_received : tcp_state::syn_sent;
+	} else if (state == tcp_state::reset) {
+		// No action: only a SYN can follow a reset.
+	} else if (tcp_flags & tcp_fin) {
+		state = tcp_state::fin_wait;
+	} else if (state != tcp_state::fin_wait) {
+		state = tcp_state::established;
+	}
+}
+
 } /* namespace holmes::net::inet */
@@ -6,44 +6,100 @@
 #ifndef HOLMES_NET_INET_FLOW_INFO
 #define HOLMES_NET_INET_FLOW_INFO
 
+#include <cstdint>
+
 namespace holmes::net::inet {
 
+/** An enumeration of TCP connection states.
+ * These are a simplification of the states defined by RFC 9293, limited
+ * to what can be inferred by a passive observer. They are used both for
+ * the state of a single endpoint, as indicated by the segments it has
+ * sent, and for the state of the connection as a whole. The order is
+ * significant: where neither endpoint has sent a FIN or RST, the state of
+ * the connection is the greater of the states of the endpoints.
+ */
+enum class tcp_state: uint8_t {
+	/** No segments seen. */
+	none,
+	/** A SYN has been sent. */
+	syn_sent,
+	/** A SYN-ACK has been sent. */
+	syn_received,
+	/** Data or acknowledgements have been sent following a SYN, or
+	 * without having seen the start of the connection. */
+	established,
+	/** A FIN has been sent by one endpoint. */
+	fin_wait,
+	/** A FIN has been sent by both endpoints. */
+	closed,
+	/** A RST has been sent. */
+	reset
+};
+
 /** A class for recording information about a flow of network traffic.
  * The main purpose of this class is to determine whether communications
  * were initiated by the source or the destination of a traffic flow.
  * It is possible for both to be true (either at different times, or less
  * commonly, as the result of an operation such as a simultaneous TCP
  * open).
+ *
+ * It also accumulates counters for the packets which make up the flow.
+ * Those fields which change for every packet are grouped together and
+ * aligned so that they fall within a single cache line, whereas the time
+ * of the first packet is written only once and so is held separately.
+ * Timestamps are measured in microseconds since the Unix epoch.
  */
 class flow_info {
 private:
-	/** True if the source is known to have initiated part or all of
-	 * this flow at the transport layer.
-	 * - For TCP this means observing segments with SYN=1 and ACK=0.
-	 * - For UDP this means observing datagrams for which the payload
-	 *   can be decoded and which corresponds to a request.
-	 *
-	 * If a UDP payload cannot be decoded due to lack of support for
-	 * the protocol in question then this flag should not be set.
-	 *
-	 * In the unlikely event of a TCP simultaneous open, this flag
-	 * should be set for the flows in both directions.
-	 */
-	bool _active = false;
-
-	/** True if the destination is presumed to have initiated part or
-	 * all of this flow at the transport layer.
-	 * - For TCP this means observing segments with SYN=1 and ACK=1.
-	 * - For UDP this means observing datagrams for which the payload
-	 *   can be decoded and which corresponds to a response.
-	 *
-	 * If a UDP payload cannot be decoded due to lack of support for
-	 * the protocol in question then this flag should not be set.
-	 *
-	 * In the unlikely event of a TCP simultaneous open, this flag
-	 * should be set for the flows in both directions.
-	 */
-	bool _passive = false;
+	/** The fields which are updated for every packet. */
+	struct alignas(32) hot_fields {
+		/** The number of packets observed. */
+		uint64_t packets = 0;
+
+		/** The number of octets observed, measured at the IP layer. */
+		uint64_t octets = 0;
+
+		/** The time at which the last packet was observed. */
+		int64_t last = 0;
+
+		/** The union of the TCP flags observed. */
+		uint16_t tcp_flags = 0;
+
+		/** True if the source is known to have initiated part or all of
+		 * this flow at the transport layer.
+		 * - For TCP this means observing segments with SYN=1 and ACK=0.
+		 * - For UDP this means observing datagrams for which the payload
+		 *   can be decoded and which corresponds to a request.
+		 *
+		 * If a UDP payload cannot be decoded due to lack of support for
+		 * the protocol in question then this flag should not be set.
+		 *
+		 * In the unlikely event of a TCP simultaneous open, this flag
+		 * should be set for the flows in both directions.
+		 */
+		bool active = false;
+
+		/** True if the destination is presumed to have initiated part or
+		 * all of this flow at the transport layer.
+		 * - For TCP this means observing segments with SYN=1 and ACK=1.
+		 * - For UDP this means observing datagrams for which the payload
+		 *   can be decoded and which corresponds to a response.
+		 *
+		 * If a UDP payload cannot be decoded due to lack of support for
+		 * the protocol in question then this flag should not be set.
+		 *
+		 * In the unlikely event of a TCP simultaneous open, this flag
+		 * should be set for the flows in both directions.
+		 */
+		bool passive = false;
+
+		/** The TCP state of the source endpoint. */
+		tcp_state state = tcp_state::none;
+	} _hot;
+	static_assert(sizeof(hot_fields) == 32);
+
+	/** The time at which the first packet was observed. */
+	int64_t _first = 0;
 public:
 	/** Create neutral flow information object. */
 	flow_info() = default;
@@ -52,8 +108,51 @@ public:
 	 * @param active true if source known to be initiator
 	 * @param passive true if destination presumed to be initiator
 	 */
-	flow_info(bool active, bool passive):
-		_active(active), _passive(passive) {}
+	flow_info(bool active, bool passive) {
+		_hot.active = active;
+		_hot.passive = passive;
+	}
+
+	/** Create flow information object with active/passive indicators
+	 * and counters.
+	 * @param active true if source known to be initiator
+	 * @param passive true if destination presumed to be initiator
+	 * @param packets the number of packets observed
+	 * @param octets the number of octets observed
+	 * @param first the time at which the first packet was observed
+	 * @param last the time at which the last packet was observed
+	 * @param tcp_flags the union of the TCP flags observed
+	 */
+	flow_info(bool active, bool passive, uint64_t packets, uint64_t octets,
+		int64_t first, int64_t last, uint16_t tcp_flags);
+
+	/** Count a packet as part of this flow.
+	 * @param timestamp the time at which the packet was observed
+	 * @param octets the length of the packet, measured at the IP layer
+	 * @param tcp_flags the TCP flags of the packet, or 0 if none
+	 */
+	void count(int64_t timestamp, uint64_t octets, uint16_t tcp_flags) {
+		if (_hot.packets == 0) {
+			_first = timestamp;
+			_hot.last = timestamp;
+		} else if (timestamp > _hot.last) {
+			_hot.last = timestamp;
+		} else if (timestamp < _first) {
+			_first = timestamp;
+		}
+		_hot.packets += 1;
+		_hot.octets += octets;
+		_hot.tcp_flags |= tcp_flags;
+	}
+
+	/** Mark the source and/or destination as initiator of this flow.
+	 * @param active true if source known to be initiator
+	 * @param passive true if destination presumed to be initiator
+	 */
+	void mark(bool active, bool passive) {
+		_hot.active |= active;
+		_hot.passive |= passive;
+	}
 
 	/** Merge this traffic flow information record with another.
 	 * @param info the traffic flow information to be merged
@@ -61,12 +160,28 @@ public:
 	 */
 	flow_info& operator|=(const flow_info& info);
 
+	/** Track the TCP state of the source endpoint.
+	 * A SYN or RST always takes effect (so that a connection can be
+	 * reopened), whereas once a FIN has been sent or the connection
+	 * has been reset, no other segment changes the state.
+	 * @param tcp_flags the TCP flags of a segment sent by the source
+	 */
+	void track(uint16_t tcp_flags);
+
+	/** Test whether any information has been recorded.
+	 * @return true if there are no packets and neither endpoint is
+	 *  known to be the initiator, otherwise false
+	 */
+	bool empty() const {
+		return !_hot.packets && !_hot.active && !_hot.passive;
+	}
+
 	/** Test for active source / passive destination.
 	 * @return true if the source is known to have initiated part or all
 	 *  of this flow, otherwise false
 	 */
 	bool active() const {
-		return _active;
+		return _hot.active;
 	}
 
 	/** Test for passive source / active destination.
@@ -74,7 +189,49 @@ public:
 	 *  or all of this flow, otherwise false
 	 */
 	bool passive() const {
-		return _passive;
+		return _hot.passive;
+	}
+
+	/** Get the number of packets observed.
+	 * @return the number of packets
+	 */
+	uint64_t packets() const {
+		return _hot.packets;
+	}
+
+	/** Get the number of octets observed, measured at the IP layer.
+	 * @return the number of octets
+	 */
+	uint64_t octets() const {
+		return _hot.octets;
+	}
+
+	/** Get the time at which the first packet was observed.
+	 * @return the timestamp, or 0 if no packets have been observed
+	 */
+	int64_t first() const {
+		return _first;
+	}
+
+	/** Get the time at which the last packet was observed.
+	 * @return the timestamp, or 0 if no packets have been observed
+	 */
+	int64_t last() const {
+		return _hot.last;
+	}
+
+	/** Get the union of the TCP flags observed.
+	 * @return the TCP flags
+	 */
+	uint16_t tcp_flags() const {
+		return _hot.tcp_flags;
+	}
+
+	/** Get the TCP state of the source endpoint.
+	 * @return the TCP state
+	 */
+	tcp_state state() const {
+		return _hot.state;
 	}
 };
 
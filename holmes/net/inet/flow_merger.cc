@@ -0,0 +1,65 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <queue>
+
+#include "holmes/net/inet/flow_merger.h"
+
+namespace holmes::net::inet {
+
+flow_merger::input::input(const octet::string& content):
+	file(content) {
+
+	advance();
+}
+
+void flow_merger::input::advance() {
+	if (file.eof()) {
+		current.reset();
+	} else {
+		current = file.read();
+	}
+}
+
+void flow_merger::add(const octet::string& content) {
+	_inputs.emplace_back(content);
+}
+
+void flow_merger::merge(const record_handler& handler) {
+	auto later = [this](size_t lhs, size_t rhs) {
+		return _inputs[rhs].current->first < _inputs[lhs].current->first;
+	};
+	std::priority_queue<size_t, std::vector<size_t>, decltype(later)>
+		queue(later);
+	for (size_t i = 0; i != _inputs.size(); ++i) {
+		if (_inputs[i].current) {
+			queue.push(i);
+		}
+	}
+
+	std::optional<flow_file::record_type> pending;
+	while (!queue.empty()) {
+		size_t index = queue.top();
+		queue.pop();
+		input& in = _inputs[index];
+		if (pending && pending->first == in.current->first) {
+			pending->second |= in.current->second;
+		} else {
+			if (pending) {
+				handler(pending->first, pending->second);
+			}
+			pending = in.current;
+		}
+		in.advance();
+		if (in.current) {
+			queue.push(index);
+		}
+	}
+	if (pending) {
+		handler(pending->first, pending->second);
+	}
+}
+
+} /* namespace holmes::net::inet */
@@ -0,0 +1,70 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_NET_INET_FLOW_MERGER
+#define HOLMES_NET_INET_FLOW_MERGER
+
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "holmes/octet/string.h"
+#include "holmes/net/inet/five_tuple.h"
+#include "holmes/net/inet/flow_info.h"
+#include "holmes/net/inet/flow_file.h"
+
+namespace holmes::net::inet {
+
+/** A class for merging sorted flow-record files.
+ * This is a k-way merge using a priority queue of inputs ordered by
+ * their current 5-tuple, so only one record per input is held in memory
+ * at any one time. Records for the same 5-tuple are combined using
+ * flow_info::operator|=.
+ */
+class flow_merger {
+public:
+	/** The type of a function for receiving merged records. */
+	typedef std::function<void(const five_tuple&, const flow_info&)>
+		record_handler;
+private:
+	/** A structure to represent the current position within an input. */
+	struct input {
+		/** The input file. */
+		flow_file file;
+
+		/** The record at the current position. */
+		std::optional<flow_file::record_type> current;
+
+		/** Construct merge input, and read the first record.
+		 * @param content the content of the input file
+		 */
+		explicit input(const octet::string& content);
+
+		/** Advance to the next record, if there is one. */
+		void advance();
+	};
+
+	/** The inputs to be merged. */
+	std::vector<input> _inputs;
+public:
+	/** Add an input file.
+	 * @param content the content of the input file
+	 * @throws parse_error if the file header is invalid
+	 */
+	void add(const octet::string& content);
+
+	/** Merge the input files.
+	 * Each distinct 5-tuple is passed to the handler once, in ascending
+	 * order, with the combined flow information from all of the inputs.
+	 * The inputs are consumed in the process.
+	 * @param handler the function to receive the merged records
+	 * @throws parse_error if an input is invalid or out of order
+	 */
+	void merge(const record_handler& handler);
+};
+
+} /* namespace holmes::net::inet */
+
+#endif
@@ -3,41 +3,206 @@
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <unistd.h>
+
+#include "holmes/libc_error.h"
+#include "holmes/octet/file.h"
 #include "holmes/net/inet/datagram.h"
 #include "holmes/net/tcp/segment.h"
+#include "holmes/net/inet/flow_file.h"
+#include "holmes/net/inet/flow_merger.h"
 #include "holmes/net/inet/flow_table.h"
 
 namespace holmes::net::inet {
 
-void flow_table::ingest(const inet::datagram& dgram,
-	const tcp::segment& seg) {
+flow_table::run::run() {
+	const char* tmpdir = std::getenv("TMPDIR");
+	std::string pattern = std::string((tmpdir) ? tmpdir : "/tmp") +
+		"/holmes-flow-XXXXXX";
+	int fd = mkstemp(pattern.data());
+	if (fd == -1) {
+		throw libc_error();
+	}
+	::close(fd);
+	_pathname = pattern;
+}
+
+flow_table::run::~run() {
+	if (!_pathname.empty()) {
+		::unlink(_pathname.c_str());
+	}
+}
+
+flow_table::flow_table(finalise_handler finalise, int64_t linger):
+	_finalise(std::move(finalise)),
+	_linger(linger) {}
+
+flow_table::flow_table(size_t budget):
+	_max_flows(std::max<size_t>(budget / connection_cost, 1)) {}
+
+void flow_table::_evict(int64_t now) {
+	while (!_closing.empty() && _closing.front().first <= now) {
+		five_tuple key = _closing.front().second;
+		_closing.pop_front();
+		auto f = _flows.find(key);
+		if (f == _flows.end() || !f->second.closed()) {
+			continue;
+		}
+
+		// Packets seen during the linger period extend it.
+		int64_t expiry = f->second.last() + _linger;
+		if (expiry > now) {
+			_closing.emplace_back(expiry, key);
+			continue;
+		}
+		_finalise(f->first, f->second);
+		_flows.erase(f);
+	}
+}
+
+void flow_table::ingest(const struct timeval& ts,
+	const inet::datagram& dgram, const tcp::segment& seg) {
 
 	five_tuple key(dgram, seg);
+	bool reverse = !key.canonical();
+	if (reverse) {
+		key = key.reverse();
+	}
 	bool active = seg.syn_flag() && !seg.ack_flag();
 	bool passive = seg.syn_flag() && seg.ack_flag();
-	_flows[key] |= flow_info(active, passive);
+	int64_t timestamp = int64_t(ts.tv_sec) * 1000000 + ts.tv_usec;
+	if (_max_flows && _flows.size() >= _max_flows &&
+		_flows.find(key) == _flows.end()) {
+		_spill();
+	}
+	connection_info& conn = _flows[key];
+	flow_info& info = conn.flow(reverse);
+	info.count(timestamp, dgram.data().length(), seg.flags());
+	info.mark(active, passive);
+	info.track(seg.flags());
+
+	if (_finalise) {
+		if ((seg.fin_flag() || seg.rst_flag()) && conn.closed()) {
+			_closing.emplace_back(timestamp + _linger, key);
+		}
+		_evict(timestamp);
+	}
+}
+
+void flow_table::finalise() {
+	if (_finalise) {
+		for (const auto& i : _flows) {
+			_finalise(i.first, i.second);
+		}
+	}
+	_flows.clear();
+	_closing.clear();
 }
 
-std::set<five_tuple> flow_table::summarise() const {
-	std::set<five_tuple> summary;
+void flow_table::_summarise(const five_tuple& flow, const flow_info& info,
+	std::map<five_tuple, flow_info>& summary) {
+
+	inet::address_value src_addr = flow.src_addr();
+	inet::address_value dst_addr = flow.dst_addr();
+	uint16_t dst_port = flow.dst_port();
+	if (!info.active()) {
+		if (info.passive()) {
+			std::swap(src_addr, dst_addr);
+			dst_port = flow.src_port();
+		} else {
+			return;
+		}
+	}
+	five_tuple key(flow.protocol(), src_addr, 0, dst_addr, dst_port);
+	summary[key] |= info;
+}
+
+void flow_table::summarise(const five_tuple& key, const connection_info& conn,
+	std::map<five_tuple, flow_info>& summary) {
+
+	_summarise(key, conn.flow(false), summary);
+	_summarise(key.reverse(), conn.flow(true), summary);
+}
+
+std::map<five_tuple, flow_info> flow_table::summarise() const {
+	std::map<five_tuple, flow_info> summary;
+	for_each([&summary](const five_tuple& flow, const flow_info& info) {
+		_summarise(flow, info, summary);
+	});
+	return summary;
+}
+
+void flow_table::_for_each(const flow_handler& handler) const {
+	// The reverse direction of a connection does not sort next to the
+	// forward direction, so the flows must be sorted first.
+	std::vector<std::pair<five_tuple, const flow_info*>> records;
+	records.reserve(_flows.size() * 2);
 	for (const auto& i : _flows) {
-		std::unique_ptr<inet::address> src_addr = i.first.src_addr().clone();
-		uint16_t src_port = i.first.src_port();
-		std::unique_ptr<inet::address> dst_addr = i.first.dst_addr().clone();
-		uint16_t dst_port = i.first.dst_port();
-		uint8_t protocol = i.first.protocol();
-		if (!i.second.active()) {
-			if (i.second.passive()) {
-				std::swap(src_addr, dst_addr);
-				std::swap(src_port, dst_port);
-			} else {
-				continue;
+		for (bool reverse : {false, true}) {
+			const flow_info& info = i.second.flow(reverse);
+			if (!info.empty()) {
+				records.emplace_back(
+					(reverse) ? i.first.reverse() : i.first, &info);
 			}
 		}
-		five_tuple key(protocol, *src_addr, 0, *dst_addr, dst_port);
-		summary.insert(key);
 	}
-	return summary;
+	std::sort(records.begin(), records.end(),
+		[](const auto& lhs, const auto& rhs) {
+			return lhs.first < rhs.first;
+		});
+
+	for (const auto& [key, info] : records) {
+		handler(key, *info);
+	}
+}
+
+flow_table::run flow_table::_write_run() const {
+	run result;
+	std::ofstream out(result.pathname(), std::ios::binary);
+	flow_file_writer writer(out);
+	_for_each([&writer](const five_tuple& key, const flow_info& info) {
+		writer.write(key, info);
+	});
+	out.close();
+	if (!out) {
+		throw std::runtime_error("failed to write flow table run");
+	}
+	return result;
+}
+
+void flow_table::_spill() {
+	_runs.push_back(_write_run());
+	_flows.clear();
+}
+
+void flow_table::for_each(const flow_handler& handler) const {
+	if (_runs.empty()) {
+		_for_each(handler);
+		return;
+	}
+
+	// Write the in-memory content to a further run (which is removed
+	// afterwards) so that it can be merged with the others.
+	run remainder = _write_run();
+	flow_merger merger;
+	for (const run& r : _runs) {
+		merger.add(octet::file(r.pathname()));
+	}
+	merger.add(octet::file(remainder.pathname()));
+	merger.merge(handler);
+}
+
+void flow_table::write(std::ostream& out) const {
+	flow_file_writer writer(out);
+	for_each([&writer](const five_tuple& key, const flow_info& info) {
+		writer.write(key, info);
+	});
 }
 
 void flow_table::dump(std::ostream& out) {
@@ -6,35 +6,244 @@
 #ifndef HOLMES_NET_INET_FLOW_TABLE
 #define HOLMES_NET_INET_FLOW_TABLE
 
+#include <deque>
+#include <functional>
 #include <map>
-#include <set>
 #include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/time.h>
 
 #include "holmes/net/inet/five_tuple.h"
 #include "holmes/net/inet/flow_info.h"
+#include "holmes/net/inet/connection_info.h"
 
 namespace holmes::net::inet {
 
-/** A class for recording information about network traffic flows. */
+/** A class for recording information about network traffic flows.
+ * Both directions of a connection are held in a single entry, keyed by
+ * the canonical form of the 5-tuple.
+ *
+ * If a finalise handler is provided then TCP connections which have been
+ * closed or reset are evicted from the table, once no packets have been
+ * seen for them for a linger period. Each is passed to the handler
+ * before being erased. Any remaining connections can be passed to the
+ * handler by calling finalise(). Without a handler, connections are
+ * retained indefinitely.
+ *
+ * Alternatively, a memory budget can be provided. Whenever the table
+ * would exceed the budget, its content is spilled to disk as a sorted
+ * run (a temporary flow-record file), and the table is cleared. The runs
+ * are merged with the remaining in-memory content by for_each(), which
+ * also underlies summarise() and write(). Since a spilled connection is
+ * no longer held in memory, its TCP state is not carried forward, and
+ * the iterators and finalise() cover only the in-memory content.
+ */
 class flow_table {
+public:
+	/** The type of a function for receiving finalised connections.
+	 * The arguments are the canonical 5-tuple and the connection
+	 * information.
+	 */
+	typedef std::function<void(const five_tuple&, const connection_info&)>
+		finalise_handler;
+
+	/** The type of a function for receiving the flows in one direction.
+	 * The arguments are the 5-tuple and the flow information.
+	 */
+	typedef std::function<void(const five_tuple&, const flow_info&)>
+		flow_handler;
+
+	/** The default linger period, in microseconds. */
+	static const int64_t default_linger = 2000000;
+
+	/** The approximate memory cost of a connection, in octets.
+	 * This includes the overhead of a node within the underlying
+	 * std::map (three pointers and a colour).
+	 */
+	static const size_t connection_cost =
+		sizeof(std::pair<const five_tuple, connection_info>) +
+		4 * sizeof(void*);
+
+	/** The type of an iterator over the connections in this table.
+	 * Connections are visited in ascending order of canonical 5-tuple.
+	 */
+	typedef std::map<five_tuple, connection_info>::const_iterator
+		const_iterator;
 private:
-	/** The flows in this table. */
-	std::map<five_tuple, flow_info> _flows;
+	/** The connections in this table, indexed by canonical 5-tuple. */
+	std::map<five_tuple, connection_info> _flows;
+
+	/** The finalise handler, or null if connections are not evicted. */
+	finalise_handler _finalise;
+
+	/** The linger period, in microseconds. */
+	int64_t _linger = default_linger;
+
+	/** Connections which have been closed or reset, in the order in
+	 * which that happened. Each is paired with the earliest time at
+	 * which it can be evicted.
+	 */
+	std::deque<std::pair<int64_t, five_tuple>> _closing;
+
+	/** A class to represent a temporary flow-record file.
+	 * The file is created on construction and removed on destruction.
+	 */
+	class run {
+	private:
+		/** The pathname of the file, or empty if moved from. */
+		std::string _pathname;
+	public:
+		/** Create a new, empty temporary file.
+		 * This is placed in the directory given by the TMPDIR
+		 * environment variable, or /tmp if that is not set.
+		 * @throws libc_error if the file could not be created
+		 */
+		run();
+
+		run(run&& that) noexcept:
+			_pathname(std::move(that._pathname)) {
+			that._pathname.clear();
+		}
+
+		run(const run&) = delete;
+		run& operator=(const run&) = delete;
+
+		~run();
+
+		/** Get the pathname of the file.
+		 * @return the pathname
+		 */
+		const std::string& pathname() const {
+			return _pathname;
+		}
+	};
+
+	/** The maximum number of connections to hold in memory, or zero
+	 * if there is no limit. */
+	size_t _max_flows = 0;
+
+	/** The runs which have been spilled to disk. */
+	std::vector<run> _runs;
+
+	/** Evict connections for which the linger period has expired.
+	 * @param now the current time, in microseconds since the epoch
+	 */
+	void _evict(int64_t now);
+
+	/** Spill the in-memory content of this table to a new run. */
+	void _spill();
+
+	/** Call a function for each flow held in memory.
+	 * This is as for for_each(), but disregarding any spilled runs.
+	 * @param handler the function to be called
+	 */
+	void _for_each(const flow_handler& handler) const;
+
+	/** Write the in-memory content of this table to a new run.
+	 * @return the run
+	 */
+	run _write_run() const;
+
+	/** Summarise the network traffic flow in one direction.
+	 * @param flow the 5-tuple of the flow
+	 * @param info the flow information
+	 * @param summary the summary to be added to
+	 */
+	static void _summarise(const five_tuple& flow, const flow_info& info,
+		std::map<five_tuple, flow_info>& summary);
 public:
+	/** Construct flow table which retains all connections. */
+	flow_table() = default;
+
+	/** Construct flow table which evicts closed connections.
+	 * @param finalise the handler for finalised connections
+	 * @param linger the linger period, in microseconds
+	 */
+	explicit flow_table(finalise_handler finalise,
+		int64_t linger = default_linger);
+
+	/** Construct flow table which spills to disk when over budget.
+	 * @param budget the memory budget for the in-memory content of
+	 *  the table, in octets
+	 */
+	explicit flow_table(size_t budget);
+
 	/** Ingest a TCP segment.
+	 * @param ts the time at which the segment was captured
 	 * @param dgram the IP datagram containing the segment
 	 * @param seg the segment to be ingested
 	 */
-	void ingest(const inet::datagram& dgram, const tcp::segment& seg);
+	void ingest(const struct timeval& ts, const inet::datagram& dgram,
+		const tcp::segment& seg);
+
+	/** Get an iterator to the first connection in this table.
+	 * @return the iterator
+	 */
+	const_iterator begin() const {
+		return _flows.begin();
+	}
+
+	/** Get an iterator to one past the last connection in this table.
+	 * @return the iterator
+	 */
+	const_iterator end() const {
+		return _flows.end();
+	}
+
+	/** Get the number of connections held in memory.
+	 * @return the number of connections
+	 */
+	size_t size() const {
+		return _flows.size();
+	}
+
+	/** Finalise all connections remaining in this table.
+	 * Each is passed to the finalise handler, if there is one, and the
+	 * table is then cleared.
+	 */
+	void finalise();
+
+	/** Call a function for each flow in this table.
+	 * Flows are visited one direction at a time, in ascending order of
+	 * 5-tuple, including those which have been spilled to disk. Flows
+	 * with the same 5-tuple are combined using flow_info::operator|=.
+	 * @param handler the function to be called
+	 */
+	void for_each(const flow_handler& handler) const;
+
+	/** Summarise the network traffic flows of one connection.
+	 * This applies the same rules as summarise(), merging the result
+	 * into an existing summary.
+	 * @param key the canonical 5-tuple of the connection
+	 * @param conn the connection information
+	 * @param summary the summary to be added to
+	 */
+	static void summarise(const five_tuple& key, const connection_info& conn,
+		std::map<five_tuple, flow_info>& summary);
 
 	/** Summarise the network traffic flows in this table.
 	 * When summarised:
 	 * - Only outbound flows from the active endpoint are reported.
 	 * - The source port number is disregarded.
+	 *
+	 * Flows which are combined as a result (including the return
+	 * direction of each flow) have their counters merged.
+	 * @return the summarised flows, with their merged information
+	 */
+	std::map<five_tuple, flow_info> summarise() const;
+
+	/** Write the content of this table as a binary flow-record file.
+	 * Each direction of a connection is written as a separate record,
+	 * unless nothing has been recorded for it.
+	 * @param out the output stream to be written to
 	 */
-	std::set<five_tuple> summarise() const;
+	void write(std::ostream& out) const;
 
 	/** Dump the content of this table to an output stream.
+	 * One line is written for each connection.
 	 * @param out the output stream to be written to
 	 */
 	void dump(std::ostream& out);
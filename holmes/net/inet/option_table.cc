@@ -0,0 +1,42 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include "holmes/net/inet/option_table.h"
+
+namespace holmes::net::inet {
+
+option_table::option_table(const octet::string& data):
+	_data(data.substr(0, 255)),
+	_count(0) {
+
+	size_t offset = 0;
+	size_t remaining = _data.length();
+	while ((remaining != 0) && (_count != capacity)) {
+		uint8_t type = _data[offset];
+		size_t length = 1;
+		if (type >= 2) {
+			length = (remaining >= 2) ? _data[offset + 1] : 2;
+			if (length < 2) {
+				length = 2;
+			}
+		}
+		if (length > remaining) {
+			length = remaining;
+		}
+
+		entry& e = _entries[_count++];
+		e.type = type;
+		e.offset = offset;
+		e.length = length;
+
+		if (type == 0) {
+			break;
+		}
+		offset += length;
+		remaining -= length;
+	}
+}
+
+} /* namespace holmes::net::inet */
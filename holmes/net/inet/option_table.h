@@ -0,0 +1,131 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_NET_INET_OPTION_TABLE
+#define HOLMES_NET_INET_OPTION_TABLE
+
+#include <cstdint>
+#include <array>
+
+#include "holmes/octet/string.h"
+
+namespace holmes::net::inet {
+
+/** A class to index the options within a TCP or IPv4 header.
+ * Both protocols use the same encoding: types 0 (end of option list) and
+ * 1 (no operation) occupy a single octet, and all other types are followed
+ * by a length octet which covers the whole option. The option area is
+ * limited to 40 octets, so there can be at most 40 options, and the table
+ * can be held inline by the segment or datagram to which it belongs
+ * without any further memory allocation.
+ *
+ * Options which extend beyond the end of the option area are truncated,
+ * as are options with a declared length of less than two octets.
+ */
+class option_table {
+public:
+	/** The maximum number of options which can be indexed. */
+	static const size_t capacity = 40;
+
+	/** A structure to represent the location of a single option. */
+	struct entry {
+		/** The option type. */
+		uint8_t type;
+
+		/** The offset of the option within the option area, in octets. */
+		uint8_t offset;
+
+		/** The length of the option, including the type and length fields,
+		 * in octets. */
+		uint8_t length;
+	};
+private:
+	/** The raw content of the option area. */
+	octet::string _data;
+
+	/** The entries in this table. */
+	std::array<entry, capacity> _entries;
+
+	/** The number of entries in this table. */
+	uint8_t _count;
+public:
+	/** Construct option table.
+	 * Parsing stops after an end of option list option, or at the end
+	 * of the option area, whichever comes first.
+	 * @param data the raw content of the option area
+	 */
+	explicit option_table(const octet::string& data);
+
+	/** Get the number of options.
+	 * @return the number of options
+	 */
+	size_t size() const {
+		return _count;
+	}
+
+	/** Test whether there are any options.
+	 * @return true if there are no options, otherwise false
+	 */
+	bool empty() const {
+		return _count == 0;
+	}
+
+	/** Get an iterator to the first entry.
+	 * @return the iterator
+	 */
+	const entry* begin() const {
+		return _entries.data();
+	}
+
+	/** Get an iterator to one past the last entry.
+	 * @return the iterator
+	 */
+	const entry* end() const {
+		return _entries.data() + _count;
+	}
+
+	/** Get the entry at a given index.
+	 * @param index the index of the required entry
+	 * @return the entry
+	 */
+	const entry& operator[](size_t index) const {
+		return _entries[index];
+	}
+
+	/** Find the first option of a given type.
+	 * @param type the required option type
+	 * @return the entry, or nullptr if not found
+	 */
+	const entry* find(uint8_t type) const {
+		for (const entry& e : *this) {
+			if (e.type == type) {
+				return &e;
+			}
+		}
+		return nullptr;
+	}
+
+	/** Get the raw content of an option.
+	 * This includes the type and length fields.
+	 * @param e the entry for the required option
+	 * @return the raw content
+	 */
+	octet::string data(const entry& e) const {
+		return _data.substr(e.offset, e.length);
+	}
+
+	/** Get the payload of an option.
+	 * This excludes the type and length fields.
+	 * @param e the entry for the required option
+	 * @return the payload
+	 */
+	octet::string payload(const entry& e) const {
+		return data(e).substr(2);
+	}
+};
+
+} /* namespace holmes::net::inet */
+
+#endif
@@ -4,25 +4,18 @@
 // GNU General Public License (version 3 or any later version).
 
 #include "holmes/parse_error.h"
-#include "holmes/bson/string.h"
 #include "holmes/net/inet4/address.h"
 
 namespace holmes::net::inet4 {
 
+using namespace bson::literals;
+
 address* address::_clone() const {
 	return new address(*this);
 }
 
 void address::_write(std::ostream& out) const {
-	auto data = this->data();
-	unsigned int width = out.width();
-	out << (data[0] & 0xff) << '.';
-	out.width(width);
-	out << (data[1] & 0xff) << '.';
-	out.width(width);
-	out << (data[2] & 0xff) << '.';
-	out.width(width);
-	out << (data[3] & 0xff);
+	out << value();
 }
 
 address::address(const octet::string& data):
@@ -33,10 +26,12 @@ address::address(const octet::string& data):
 	}
 }
 
-bson::document address::to_bson() const {
-	bson::document bson_addr;
-	bson_addr.append("addr", bson::string(*this));
-	return bson_addr;
+void address::emit(bson::emitter& em) const {
+	em.begin_document();
+	if (em.key("addr"_key)) {
+		em.formatted(value());
+	}
+	em.end_document();
 }
 
 } /* namespace holmes::net::inet4 */
@@ -7,10 +7,13 @@
 #define HOLMES_NET_INET4_ADDRESS
 
 #include "holmes/net/inet/address.h"
+#include "holmes/net/inet4/address_value.h"
 
 namespace holmes::net::inet4 {
 
-/** A class to represent an IPv4 address. */
+/** A class to represent an IPv4 address.
+ * This is a polymorphic adaptor for inet4::address_value.
+ */
 class address:
 	public inet::address {
 protected:
@@ -22,6 +25,12 @@ public:
 	 */
 	explicit address(const octet::string& data);
 
+	/** Construct IPv4 address from an address value.
+	 * @param value the required address value
+	 */
+	explicit address(const address_value& value):
+		address(octet::string(value.data(), address_value::length)) {}
+
 	/** Clone this address.
 	 * @return the cloned address
 	 */
@@ -29,7 +38,18 @@ public:
 		return std::unique_ptr<address>(_clone());
 	}
 
-	bson::document to_bson() const override;
+	/** Get the value of this address.
+	 * @return the address value
+	 */
+	address_value value() const {
+		return address_value(data());
+	}
+
+	operator std::string() const override {
+		return value();
+	}
+
+	void emit(bson::emitter& em) const override;
 };
 
 } /* namespace holmes::net::inet4 */
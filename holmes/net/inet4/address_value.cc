@@ -0,0 +1,97 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include "holmes/parse_error.h"
+#include "holmes/net/inet4/address_value.h"
+
+namespace holmes::net::inet4 {
+
+namespace {
+
+/** A structure to represent an octet in decimal form. */
+struct decimal_octet {
+	/** The decimal digits. */
+	char digits[3];
+
+	/** The number of decimal digits. */
+	unsigned char length;
+};
+
+/** Make a table of octets in decimal form.
+ * @return the table, indexed by octet value
+ */
+constexpr std::array<decimal_octet, 256> make_decimal_table() {
+	std::array<decimal_octet, 256> table{};
+	for (unsigned int i = 0; i != 256; ++i) {
+		decimal_octet& entry = table[i];
+		if (i >= 100) {
+			entry.digits[0] = '0' + i / 100;
+			entry.digits[1] = '0' + i / 10 % 10;
+			entry.digits[2] = '0' + i % 10;
+			entry.length = 3;
+		} else if (i >= 10) {
+			entry.digits[0] = '0' + i / 10;
+			entry.digits[1] = '0' + i % 10;
+			entry.length = 2;
+		} else {
+			entry.digits[0] = '0' + i;
+			entry.length = 1;
+		}
+	}
+	return table;
+}
+
+/** A table of octets in decimal form, indexed by octet value. */
+constexpr std::array<decimal_octet, 256> decimal_table =
+	make_decimal_table();
+
+} /* anonymous namespace */
+
+address_value::address_value(const octet::string& data) {
+	if (data.length() != length) {
+		throw parse_error("IPv4 address must be 4 octets long");
+	}
+	std::memcpy(_octets.data(), data.data(), length);
+}
+
+address_value::operator std::string() const {
+	char buffer[max_chars];
+	auto result = to_chars(buffer, buffer + max_chars, *this);
+	return std::string(buffer, result.ptr);
+}
+
+std::to_chars_result to_chars(char* first, char* last,
+	const address_value& addr) {
+
+	const unsigned char* data = addr.data();
+	for (unsigned int i = 0; i != address_value::length; ++i) {
+		const decimal_octet& entry = decimal_table[data[i]];
+		size_t count = entry.length + ((i != 0) ? 1 : 0);
+		if (static_cast<size_t>(last - first) < count) {
+			return {last, std::errc::value_too_large};
+		}
+		if (i != 0) {
+			*first++ = '.';
+		}
+		std::memcpy(first, entry.digits, entry.length);
+		first += entry.length;
+	}
+	return {first, std::errc()};
+}
+
+std::ostream& operator<<(std::ostream& out, const address_value& addr) {
+	const unsigned char* data = addr.data();
+	unsigned int width = out.width();
+	out << (data[0] & 0xff) << '.';
+	out.width(width);
+	out << (data[1] & 0xff) << '.';
+	out.width(width);
+	out << (data[2] & 0xff) << '.';
+	out.width(width);
+	out << (data[3] & 0xff);
+	return out;
+}
+
+} /* namespace holmes::net::inet4 */
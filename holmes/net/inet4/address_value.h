@@ -0,0 +1,104 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_NET_INET4_ADDRESS_VALUE
+#define HOLMES_NET_INET4_ADDRESS_VALUE
+
+#include <cstring>
+#include <array>
+#include <charconv>
+#include <compare>
+#include <string>
+#include <iostream>
+
+#include "holmes/octet/string.h"
+
+namespace holmes::net::inet4 {
+
+/** A class to represent an IPv4 address by value.
+ * The address is held inline, so it can be constructed, copied and
+ * compared without any memory allocation or virtual function calls.
+ * Addresses are ordered lexicographically by octet.
+ */
+class address_value {
+public:
+	/** The length of an IPv4 address, in octets. */
+	static const size_t length = 4;
+
+	/** The maximum length of an IPv4 address in dotted decimal form. */
+	static const size_t max_chars = 15;
+private:
+	/** The raw content of this address. */
+	std::array<unsigned char, length> _octets;
+public:
+	/** Construct unspecified IPv4 address (0.0.0.0). */
+	address_value():
+		_octets{} {}
+
+	/** Construct IPv4 address from raw content.
+	 * @param data the required raw content
+	 * @throws parse_error if the content is not 4 octets long
+	 */
+	explicit address_value(const octet::string& data);
+
+	/** Construct IPv4 address from a pointer to raw content.
+	 * @param data a pointer to the first of 4 octets
+	 */
+	explicit address_value(const unsigned char* data) {
+		std::memcpy(_octets.data(), data, length);
+	}
+
+	/** Get the raw content of this address.
+	 * @return a pointer to the first octet
+	 */
+	const unsigned char* data() const {
+		return _octets.data();
+	}
+
+	/** Get the length of this address.
+	 * @return the length, in octets
+	 */
+	static constexpr size_t size() {
+		return length;
+	}
+
+	/** Convert this address to a string, in dotted decimal form.
+	 * @return the address as a string
+	 */
+	operator std::string() const;
+
+	friend bool operator==(const address_value&,
+		const address_value&) = default;
+	friend std::strong_ordering operator<=>(const address_value&,
+		const address_value&) = default;
+};
+
+/** Write an IPv4 address to a character buffer in dotted decimal form.
+ * This follows the conventions of std::to_chars: no terminating null is
+ * written, and if the buffer is too small then the result has an error
+ * code of std::errc::value_too_large and a pointer equal to last.
+ * A buffer of address_value::max_chars characters is always sufficient.
+ * @param first a pointer to the start of the buffer
+ * @param last a pointer to the end of the buffer
+ * @param addr the IPv4 address
+ * @return a pointer to one past the last character written, and an
+ *  error code
+ */
+std::to_chars_result to_chars(char* first, char* last,
+	const address_value& addr);
+
+/** Write an IPv4 address to an output stream in dotted decimal form.
+ * If a field width has been specified, then it applies individually
+ * to each component of the address (but does not remain in effect
+ * following the final component).
+ * @param out the output stream
+ * @param addr the IPv4 address
+ * @return the output stream
+ */
+std::ostream& operator<<(std::ostream& out, const address_value& addr);
+
+} /* namespace holmes::net::inet4 */
+
+#endif
@@ -7,13 +7,12 @@
 #define HOLMES_NET_INET4_DATAGRAM
 
 #include <cstdint>
-#include <memory>
-#include <vector>
+#include <optional>
 
 #include "holmes/octet/string.h"
 #include "holmes/net/inet/datagram.h"
-#include "holmes/net/inet4/address.h"
-#include "holmes/net/inet4/option.h"
+#include "holmes/net/inet4/address_value.h"
+#include "holmes/net/inet/option_table.h"
 
 namespace holmes::net::inet4 {
 
@@ -21,25 +20,11 @@ namespace holmes::net::inet4 {
 class datagram:
 	public inet::datagram {
 private:
-	/** A type to represent a list of options. */
-	typedef std::vector<std::unique_ptr<option>> option_list;
-
 	/** The raw content. */
 	octet::string _data;
 
-	/** The source address. */
-	mutable std::unique_ptr<address> _src_addr;
-
-	/** The destination address. */
-	mutable std::unique_ptr<address> _dst_addr;
-
-	/** The list of options. */
-	mutable std::unique_ptr<option_list> _options;
-
-	/** Make the list of options.
-	 * @return the newly-created list of options
-	 */
-	std::unique_ptr<option_list> _make_options() const;
+	/** The table of options. */
+	mutable std::optional<inet::option_table> _options;
 public:
 	/** Construct IPv4 datagram.
 	 * @param data a source of raw content
@@ -136,26 +121,20 @@ public:
 	 */
 	uint16_t calculated_checksum() const;
 
-	const address& src_addr() const override {
-		if (!_src_addr) {
-			_src_addr = std::make_unique<address>(_data.substr(12, 4));
-		}
-		return *_src_addr;
+	inet::address_value src_addr() const override {
+		return address_value(_data.substr(12, 4));
 	}
 
-	const address& dst_addr() const override {
-		if (!_dst_addr) {
-			_dst_addr = std::make_unique<address>(_data.substr(16, 4));
-		}
-		return *_dst_addr;
+	inet::address_value dst_addr() const override {
+		return address_value(_data.substr(16, 4));
 	}
 
-	/** Get the list of options.
-	 * @return the list of options
+	/** Get the table of options.
+	 * @return the table of options
 	 */
-	const option_list& options() const {
+	const inet::option_table& options() const {
 		if (!_options) {
-			_options = _make_options();
+			_options.emplace(_data.substr(0, ihl() * 4).substr(20));
 		}
 		return *_options;
 	}
@@ -167,7 +146,7 @@ public:
 		return _data.substr(ihl() * 4);
 	}
 
-	bson::document to_bson() const override;
+	void emit(bson::emitter& em) const override;
 	inet::checksum make_pseudo_header_checksum(
 		uint8_t protocol, size_t length) const override;
 };
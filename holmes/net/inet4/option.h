@@ -21,6 +21,12 @@ class option:
 private:
     /** The raw content. */
     octet::string _data;
+protected:
+	/** Emit the members of the BSON description of this option.
+	 * Subclasses which add members should call this function first.
+	 * @param em the emitter to receive the members
+	 */
+	virtual void _emit_members(bson::emitter& em) const;
 public:
 	/** Construct IPv4 option.
 	 * @param data a source of raw content
@@ -46,13 +52,22 @@ public:
 	 */
 	virtual std::string name() const;
 
-	bson::document to_bson() const override;
+	void emit(bson::emitter& em) const override;
 
 	/** Parse an IPv4 option.
 	 * @param data a source of raw content
 	 * @return the resulting option
 	 */
 	static std::unique_ptr<option> parse(octet::string& data);
+
+	/** Describe an option without retaining it.
+	 * This constructs an option of the appropriate class on the stack,
+	 * so that a BSON description can be emitted without any heap
+	 * allocation for the option itself.
+	 * @param em the emitter to receive the description
+	 * @param data the raw content of the option
+	 */
+	static void describe(bson::emitter& em, octet::string data);
 };
 
 } /* namespace holmes::net::inet4 */
@@ -4,58 +4,18 @@
 // GNU General Public License (version 3 or any later version).
 
 #include "holmes/parse_error.h"
-#include "holmes/bson/string.h"
 #include "holmes/net/inet6/address.h"
 
 namespace holmes::net::inet6 {
 
+using namespace bson::literals;
+
 address* address::_clone() const {
 	return new address(*this);
 }
 
 void address::_write(std::ostream& out) const {
-	auto& _data = data();
-	uint16_t words[8];
-	unsigned int maxrunpos = 0;
-	unsigned int maxrunlen = 0;
-	unsigned int currunpos = 0;
-	for (unsigned int i = 0; i != 8; ++i) {
-		uint16_t word = get_uint16(_data, i * 2);
-		words[i] = word;
-		if (word != 0) {
-			unsigned int currunlen = i - currunpos;
-			if (currunlen > maxrunlen) {
-				maxrunpos = currunpos;
-				maxrunlen = currunlen;
-			}
-			currunpos = i + 1;
-		}
-	}
-	unsigned int currunlen = 8 - currunpos;
-	if (currunlen > maxrunlen) {
-		maxrunpos = currunpos;
-		maxrunlen = currunlen;
-	}
-	if (maxrunlen < 2) {
-		maxrunlen = 0;
-	}
-
-	std::ios_base::fmtflags flags(out.flags());
-	out << std::hex;
-	for (unsigned int i = 0; i != 8; ++i) {
-		if ((i < maxrunpos) || (i >= maxrunpos + maxrunlen)) {
-			if (i != 0) {
-				out << ":";
-			}
-			out << words[i];
-		} else if (i == maxrunpos) {
-			out << ":";
-		}
-	}
-	if (maxrunpos + maxrunlen == 8) {
-		out << ":";
-	}
-	out.flags(flags);
+	out << value();
 }
 
 address::address(const octet::string& data):
@@ -66,10 +26,12 @@ address::address(const octet::string& data):
 	}
 }
 
-bson::document address::to_bson() const {
-	bson::document bson_addr;
-	bson_addr.append("addr", bson::string(*this));
-	return bson_addr;
+void address::emit(bson::emitter& em) const {
+	em.begin_document();
+	if (em.key("addr"_key)) {
+		em.formatted(value());
+	}
+	em.end_document();
 }
 
 } /* namespace holmes::net::inet6 */
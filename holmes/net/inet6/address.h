@@ -7,21 +7,30 @@
 #define HOLMES_NET_INET6_ADDRESS
 
 #include "holmes/net/inet/address.h"
+#include "holmes/net/inet6/address_value.h"
 
 namespace holmes::net::inet6 {
 
-/** A class to represent an IPv6 address. */
+/** A class to represent an IPv6 address.
+ * This is a polymorphic adaptor for inet6::address_value.
+ */
 class address:
 	public inet::address {
 protected:
 	address* _clone() const override;
 	void _write(std::ostream& out) const override;
 public:
-	/** Construct IPv4 address from raw content.
+	/** Construct IPv6 address from raw content.
 	 * @param data the required raw content
 	 */
 	explicit address(const octet::string& data);
 
+	/** Construct IPv6 address from an address value.
+	 * @param value the required address value
+	 */
+	explicit address(const address_value& value):
+		address(octet::string(value.data(), address_value::length)) {}
+
 	/** Clone this address.
 	 * @return the cloned address
 	 */
@@ -29,7 +38,18 @@ public:
 		return std::unique_ptr<address>(_clone());
 	}
 
-        bson::document to_bson() const override;
+	/** Get the value of this address.
+	 * @return the address value
+	 */
+	address_value value() const {
+		return address_value(data());
+	}
+
+	operator std::string() const override {
+		return value();
+	}
+
+	void emit(bson::emitter& em) const override;
 };
 
 } /* namespace holmes::net::inet6 */
@@ -0,0 +1,116 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include "holmes/parse_error.h"
+#include "holmes/net/inet6/address_value.h"
+
+namespace holmes::net::inet6 {
+
+namespace {
+
+/** Find the run of zero words to be compressed.
+ * This is the longest run of two or more zero words, or the first such
+ * run if there is more than one of the maximum length.
+ * @param addr the IPv6 address
+ * @param maxrunpos a variable to receive the index of the first word
+ * @param maxrunlen a variable to receive the number of words, or 0 if none
+ */
+void find_zero_run(const address_value& addr, unsigned int& maxrunpos,
+	unsigned int& maxrunlen) {
+
+	maxrunpos = 0;
+	maxrunlen = 0;
+	unsigned int currunpos = 0;
+	for (unsigned int i = 0; i != 8; ++i) {
+		if (addr.word(i) != 0) {
+			unsigned int currunlen = i - currunpos;
+			if (currunlen > maxrunlen) {
+				maxrunpos = currunpos;
+				maxrunlen = currunlen;
+			}
+			currunpos = i + 1;
+		}
+	}
+	unsigned int currunlen = 8 - currunpos;
+	if (currunlen > maxrunlen) {
+		maxrunpos = currunpos;
+		maxrunlen = currunlen;
+	}
+	if (maxrunlen < 2) {
+		maxrunlen = 0;
+	}
+}
+
+} /* anonymous namespace */
+
+address_value::address_value(const octet::string& data) {
+	if (data.length() != length) {
+		throw parse_error("IPv6 address must be 16 octets long");
+	}
+	std::memcpy(_octets.data(), data.data(), length);
+}
+
+address_value::operator std::string() const {
+	char buffer[max_chars];
+	auto result = to_chars(buffer, buffer + max_chars, *this);
+	return std::string(buffer, result.ptr);
+}
+
+std::to_chars_result to_chars(char* first, char* last,
+	const address_value& addr) {
+
+	unsigned int maxrunpos;
+	unsigned int maxrunlen;
+	find_zero_run(addr, maxrunpos, maxrunlen);
+
+	char buffer[address_value::max_chars];
+	char* ptr = buffer;
+	for (unsigned int i = 0; i != 8; ++i) {
+		if ((i < maxrunpos) || (i >= maxrunpos + maxrunlen)) {
+			if (i != 0) {
+				*ptr++ = ':';
+			}
+			ptr = std::to_chars(ptr, ptr + 4, addr.word(i), 16).ptr;
+		} else if (i == maxrunpos) {
+			*ptr++ = ':';
+		}
+	}
+	if (maxrunpos + maxrunlen == 8) {
+		*ptr++ = ':';
+	}
+
+	size_t count = ptr - buffer;
+	if (static_cast<size_t>(last - first) < count) {
+		return {last, std::errc::value_too_large};
+	}
+	std::memcpy(first, buffer, count);
+	return {first + count, std::errc()};
+}
+
+std::ostream& operator<<(std::ostream& out, const address_value& addr) {
+	unsigned int maxrunpos;
+	unsigned int maxrunlen;
+	find_zero_run(addr, maxrunpos, maxrunlen);
+
+	std::ios_base::fmtflags flags(out.flags());
+	out << std::hex;
+	for (unsigned int i = 0; i != 8; ++i) {
+		if ((i < maxrunpos) || (i >= maxrunpos + maxrunlen)) {
+			if (i != 0) {
+				out << ":";
+			}
+			out << addr.word(i);
+		} else if (i == maxrunpos) {
+			out << ":";
+		}
+	}
+	if (maxrunpos + maxrunlen == 8) {
+		out << ":";
+	}
+	out.flags(flags);
+	return out;
+}
+
+} /* namespace holmes::net::inet6 */
@@ -0,0 +1,112 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_NET_INET6_ADDRESS_VALUE
+#define HOLMES_NET_INET6_ADDRESS_VALUE
+
+#include <cstring>
+#include <array>
+#include <charconv>
+#include <compare>
+#include <string>
+#include <iostream>
+
+#include "holmes/octet/string.h"
+
+namespace holmes::net::inet6 {
+
+/** A class to represent an IPv6 address by value.
+ * The address is held inline, so it can be constructed, copied and
+ * compared without any memory allocation or virtual function calls.
+ * Addresses are ordered lexicographically by octet.
+ */
+class address_value {
+public:
+	/** The length of an IPv6 address, in octets. */
+	static const size_t length = 16;
+
+	/** The maximum length of an IPv6 address in canonical form. */
+	static const size_t max_chars = 39;
+private:
+	/** The raw content of this address. */
+	std::array<unsigned char, length> _octets;
+public:
+	/** Construct unspecified IPv6 address (::). */
+	address_value():
+		_octets{} {}
+
+	/** Construct IPv6 address from raw content.
+	 * @param data the required raw content
+	 * @throws parse_error if the content is not 16 octets long
+	 */
+	explicit address_value(const octet::string& data);
+
+	/** Construct IPv6 address from a pointer to raw content.
+	 * @param data a pointer to the first of 16 octets
+	 */
+	explicit address_value(const unsigned char* data) {
+		std::memcpy(_octets.data(), data, length);
+	}
+
+	/** Get the raw content of this address.
+	 * @return a pointer to the first octet
+	 */
+	const unsigned char* data() const {
+		return _octets.data();
+	}
+
+	/** Get the length of this address.
+	 * @return the length, in octets
+	 */
+	static constexpr size_t size() {
+		return length;
+	}
+
+	/** Get one of the 16-bit words which make up this address.
+	 * @param index the index of the required word, from 0 to 7
+	 * @return the word
+	 */
+	uint16_t word(unsigned int index) const {
+		return (_octets[index * 2] << 8) | _octets[index * 2 + 1];
+	}
+
+	/** Convert this address to a string, in canonical form.
+	 * @return the address as a string
+	 */
+	operator std::string() const;
+
+	friend bool operator==(const address_value&,
+		const address_value&) = default;
+	friend std::strong_ordering operator<=>(const address_value&,
+		const address_value&) = default;
+};
+
+/** Write an IPv6 address to a character buffer in canonical form.
+ * The format is as recommended by RFC 5952, with lower case hexadecimal
+ * digits. This follows the conventions of std::to_chars: no terminating
+ * null is written, and if the buffer is too small then the result has an
+ * error code of std::errc::value_too_large and a pointer equal to last.
+ * A buffer of address_value::max_chars characters is always sufficient.
+ * @param first a pointer to the start of the buffer
+ * @param last a pointer to the end of the buffer
+ * @param addr the IPv6 address
+ * @return a pointer to one past the last character written, and an
+ *  error code
+ */
+std::to_chars_result to_chars(char* first, char* last,
+	const address_value& addr);
+
+/** Write an IPv6 address to an output stream in canonical form.
+ * The longest run of two or more zero words is compressed, as recommended
+ * by RFC 5952. The case of hexadecimal digits follows the stream state.
+ * @param out the output stream
+ * @param addr the IPv6 address
+ * @return the output stream
+ */
+std::ostream& operator<<(std::ostream& out, const address_value& addr);
+
+} /* namespace holmes::net::inet6 */
+
+#endif
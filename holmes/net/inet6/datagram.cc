@@ -5,15 +5,13 @@
 
 #include <arpa/inet.h>
 
-#include "holmes/bson/int32.h"
-#include "holmes/bson/int64.h"
-#include "holmes/bson/binary.h"
-#include "holmes/bson/string.h"
 #include "holmes/net/inet/checksum.h"
 #include "holmes/net/inet6/datagram.h"
 
 namespace holmes::net::inet6 {
 
+using namespace bson::literals;
+
 datagram::datagram(octet::string& data) {
 	size_t length = 40;
 	try {
@@ -24,18 +22,36 @@ datagram::datagram(octet::string& data) {
 	_data = read(data, length);
 }
 
-bson::document datagram::to_bson() const {
-	bson::document bson_datagram;
-	bson_datagram.append("version", bson::int32(version()));
-	bson_datagram.append("traffic_class", bson::int32(traffic_class()));
-	bson_datagram.append("flow_label", bson::int32(flow_label()));
-	bson_datagram.append("payload_length", bson::int64(payload_length()));
-	bson_datagram.append("next_header", bson::int32(protocol()));
-	bson_datagram.append("hop_limit", bson::int32(hop_limit()));
-	bson_datagram.append("src_addr", bson::string(src_addr()));
-	bson_datagram.append("dst_addr", bson::string(dst_addr()));
-	bson_datagram.append("payload", bson::binary(payload()));
-	return bson_datagram;
+void datagram::emit(bson::emitter& em) const {
+	em.begin_document();
+	if (em.key("version"_key)) {
+		em.int32(version());
+	}
+	if (em.key("traffic_class"_key)) {
+		em.int32(traffic_class());
+	}
+	if (em.key("flow_label"_key)) {
+		em.int32(flow_label());
+	}
+	if (em.key("payload_length"_key)) {
+		em.int64(payload_length());
+	}
+	if (em.key("next_header"_key)) {
+		em.int32(protocol());
+	}
+	if (em.key("hop_limit"_key)) {
+		em.int32(hop_limit());
+	}
+	if (em.key("src_addr"_key)) {
+		em.formatted(src_addr());
+	}
+	if (em.key("dst_addr"_key)) {
+		em.formatted(dst_addr());
+	}
+	if (em.key("payload"_key)) {
+		em.binary(payload());
+	}
+	em.end_document();
 }
 
 inet::checksum datagram::make_pseudo_header_checksum(
@@ -7,12 +7,10 @@
 #define HOLMES_NET_INET6_DATAGRAM
 
 #include <cstdint>
-#include <memory>
-#include <vector>
 
 #include "holmes/octet/string.h"
 #include "holmes/net/inet/datagram.h"
-#include "holmes/net/inet6/address.h"
+#include "holmes/net/inet6/address_value.h"
 
 namespace holmes::net::inet6 {
 
@@ -22,12 +20,6 @@ class datagram:
 private:
 	/** The raw content. */
 	octet::string _data;
-
-	/** The source address. */
-	mutable std::unique_ptr<address> _src_addr;
-
-	/** The destination address. */
-	mutable std::unique_ptr<address> _dst_addr;
 public:
 	/** Construct IPv6 datagram.
 	 * @param data the raw content of the datagram
@@ -71,25 +63,19 @@ public:
 		return get_uint8(_data, 7);
 	}
 
-	const address& src_addr() const override {
-		if (!_src_addr) {
-			_src_addr = std::make_unique<address>(_data.substr(8, 16));
-		}
-		return *_src_addr;
+	inet::address_value src_addr() const override {
+		return address_value(_data.substr(8, 16));
 	}
 
-	const address& dst_addr() const override {
-		if (!_dst_addr) {
-			_dst_addr = std::make_unique<address>(_data.substr(24, 16));
-		}
-		return *_dst_addr;
+	inet::address_value dst_addr() const override {
+		return address_value(_data.substr(24, 16));
 	}
 
 	octet::string payload() const override {
 		return _data.substr(40);
 	}
 
-	bson::document to_bson() const override;
+	void emit(bson::emitter& em) const override;
 	inet::checksum make_pseudo_header_checksum(
 		uint8_t protocol, size_t length) const override;
 };
@@ -0,0 +1,215 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <ctime>
+#include <iterator>
+#include <stdexcept>
+
+#include "holmes/net/ipfix/exporter.h"
+
+namespace holmes::net::ipfix {
+
+/** The length of an IPFIX message header, in octets. */
+static const size_t header_length = 16;
+
+/** The length of an IPFIX set header, in octets. */
+static const size_t set_header_length = 4;
+
+/** The set ID for a template set. */
+static const uint16_t template_set_id = 2;
+
+/** A structure to describe a field specifier within a template. */
+struct field_specifier {
+	/** The information element ID. */
+	uint16_t id;
+
+	/** The field length, in octets. */
+	uint16_t length;
+};
+
+/** The field specifiers for the IPv4 template. */
+static const field_specifier inet4_fields[] = {
+	{8, 4},   // sourceIPv4Address
+	{12, 4},  // destinationIPv4Address
+	{7, 2},   // sourceTransportPort
+	{11, 2},  // destinationTransportPort
+	{4, 1},   // protocolIdentifier
+	{239, 1}, // biflowDirection
+	{2, 8},   // packetDeltaCount
+	{1, 8},   // octetDeltaCount
+	{152, 8}, // flowStartMilliseconds
+	{153, 8}, // flowEndMilliseconds
+	{6, 2}    // tcpControlBits
+};
+
+/** The field specifiers for the IPv6 template. */
+static const field_specifier inet6_fields[] = {
+	{27, 16}, // sourceIPv6Address
+	{28, 16}, // destinationIPv6Address
+	{7, 2},   // sourceTransportPort
+	{11, 2},  // destinationTransportPort
+	{4, 1},   // protocolIdentifier
+	{239, 1}, // biflowDirection
+	{2, 8},   // packetDeltaCount
+	{1, 8},   // octetDeltaCount
+	{152, 8}, // flowStartMilliseconds
+	{153, 8}, // flowEndMilliseconds
+	{6, 2}    // tcpControlBits
+};
+
+/** Get the length of a data record for a given template.
+ * @param fields the field specifiers of the template
+ * @return the length of the record, in octets
+ */
+template<size_t N>
+static size_t record_length(const field_specifier (&fields)[N]) {
+	size_t length = 0;
+	for (const field_specifier& field : fields) {
+		length += field.length;
+	}
+	return length;
+}
+
+exporter::exporter(size_t max_length, bool resend_templates,
+	uint32_t domain):
+	_max_length(max_length),
+	_resend_templates(resend_templates),
+	_domain(domain) {
+
+	// Every message must have room for the templates and one record.
+	size_t template_length = set_header_length + 8 +
+		4 * (std::size(inet4_fields) + std::size(inet6_fields));
+	size_t min_length = header_length + template_length +
+		set_header_length + record_length(inet6_fields);
+	if (max_length > 0xffff || max_length < min_length) {
+		throw std::invalid_argument("invalid maximum IPFIX message length");
+	}
+}
+
+void exporter::_put(uint64_t value, size_t size) {
+	for (size_t i = size; i != 0; --i) {
+		_message.push_back(value >> ((i - 1) * 8));
+	}
+}
+
+void exporter::_patch(size_t offset, uint32_t value, size_t size) {
+	for (size_t i = size; i != 0; --i) {
+		_message[offset + size - i] = value >> ((i - 1) * 8);
+	}
+}
+
+void exporter::_begin_message() {
+	_put(version, 2);
+	_put(0, 2);        // length, filled in by flush()
+	_put(0, 4);        // export time, filled in by flush()
+	_put(0, 4);        // sequence number, filled in by flush()
+	_put(_domain, 4);
+	if (!_templates_sent || _resend_templates) {
+		_write_templates();
+		_templates_sent = true;
+	}
+}
+
+void exporter::_write_templates() {
+	size_t offset = _message.size();
+	_put(template_set_id, 2);
+	_put(0, 2);
+	_put(inet4_template_id, 2);
+	_put(std::size(inet4_fields), 2);
+	for (const field_specifier& field : inet4_fields) {
+		_put(field.id, 2);
+		_put(field.length, 2);
+	}
+	_put(inet6_template_id, 2);
+	_put(std::size(inet6_fields), 2);
+	for (const field_specifier& field : inet6_fields) {
+		_put(field.id, 2);
+		_put(field.length, 2);
+	}
+	_patch(offset + 2, _message.size() - offset, 2);
+}
+
+void exporter::_end_set() {
+	if (_set_offset) {
+		_patch(_set_offset + 2, _message.size() - _set_offset, 2);
+		_set_offset = 0;
+	}
+}
+
+void exporter::add(const inet::five_tuple& key, const inet::flow_info& info) {
+	unsigned int addr_version = key.src_addr().version();
+	if (addr_version == 0 || key.dst_addr().version() != addr_version) {
+		throw std::invalid_argument("unsupported addresses for IPFIX export");
+	}
+	bool is_inet6 = addr_version == 6;
+	uint16_t id = (is_inet6) ? inet6_template_id : inet4_template_id;
+	size_t length = (is_inet6) ?
+		record_length(inet6_fields) : record_length(inet4_fields);
+
+	// Start a new message if the record would not fit in this one.
+	if (!_message.empty()) {
+		size_t needed = length;
+		if (!_set_offset || _set_id != id) {
+			needed += set_header_length;
+		}
+		if (_message.size() + needed > _max_length) {
+			flush();
+		}
+	}
+	if (_message.empty()) {
+		_begin_message();
+	}
+
+	// Start a new data set if the template has changed.
+	if (!_set_offset || _set_id != id) {
+		_end_set();
+		_set_offset = _message.size();
+		_set_id = id;
+		_put(id, 2);
+		_put(0, 2);
+	}
+
+	uint8_t direction = 0;
+	if (info.active() && !info.passive()) {
+		direction = 1;
+	} else if (info.passive() && !info.active()) {
+		direction = 2;
+	}
+
+	_message.insert(_message.end(), key.src_addr().data(),
+		key.src_addr().data() + key.src_addr().size());
+	_message.insert(_message.end(), key.dst_addr().data(),
+		key.dst_addr().data() + key.dst_addr().size());
+	_put(key.src_port(), 2);
+	_put(key.dst_port(), 2);
+	_put(key.protocol(), 1);
+	_put(direction, 1);
+	_put(info.packets(), 8);
+	_put(info.octets(), 8);
+	_put(info.first() / 1000, 8);
+	_put(info.last() / 1000, 8);
+	_put(info.tcp_flags(), 2);
+	_count += 1;
+}
+
+void exporter::flush() {
+	if (_message.empty()) {
+		if (_templates_sent) {
+			return;
+		}
+		_begin_message();
+	}
+	_end_set();
+	_patch(2, _message.size(), 2);
+	_patch(4, std::time(nullptr), 4);
+	_patch(8, _sequence, 4);
+	_send(_message.data(), _message.size());
+
+	_sequence += _count;
+	_count = 0;
+	_message.clear();
+}
+
+} /* namespace holmes::net::ipfix */
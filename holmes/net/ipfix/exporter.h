@@ -0,0 +1,137 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_NET_IPFIX_EXPORTER
+#define HOLMES_NET_IPFIX_EXPORTER
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "holmes/net/inet/five_tuple.h"
+#include "holmes/net/inet/flow_info.h"
+
+namespace holmes::net::ipfix {
+
+/** An abstract base class for exporting flows as IPFIX messages.
+ * This implements the IPFIX protocol as specified by RFC 7011. Flows
+ * are described by two templates, one for IPv4 and one for IPv6, each
+ * consisting of the fields of a 5-tuple and the flow information:
+ *
+ * - sourceIPv4Address (8) or sourceIPv6Address (27)
+ * - destinationIPv4Address (12) or destinationIPv6Address (28)
+ * - sourceTransportPort (7)
+ * - destinationTransportPort (11)
+ * - protocolIdentifier (4)
+ * - biflowDirection (239)
+ * - packetDeltaCount (2)
+ * - octetDeltaCount (1)
+ * - flowStartMilliseconds (152)
+ * - flowEndMilliseconds (153)
+ * - tcpControlBits (6)
+ *
+ * The biflowDirection is 1 (initiator) if the source is known to have
+ * been the active endpoint, 2 (reverseInitiator) if the destination is
+ * presumed to have been, or 0 (arbitrary) if neither or both.
+ *
+ * Records are accumulated into a message until it reaches the maximum
+ * length, at which point it is passed to _send(). Any partial message
+ * is sent by flush(), which must be called once all flows have been
+ * added.
+ */
+class exporter {
+public:
+	/** The IPFIX version number. */
+	static const uint16_t version = 10;
+
+	/** The template ID for IPv4 flows. */
+	static const uint16_t inet4_template_id = 256;
+
+	/** The template ID for IPv6 flows. */
+	static const uint16_t inet6_template_id = 257;
+private:
+	/** The maximum length of a message, in octets. */
+	size_t _max_length;
+
+	/** True if the templates should be included in every message,
+	 * false if only in the first. */
+	bool _resend_templates;
+
+	/** True if the templates have been sent at least once. */
+	bool _templates_sent = false;
+
+	/** The observation domain ID. */
+	uint32_t _domain;
+
+	/** The number of data records sent in previous messages. */
+	uint32_t _sequence = 0;
+
+	/** The number of data records in the current message. */
+	uint32_t _count = 0;
+
+	/** The current message, or empty if none has been started. */
+	std::vector<unsigned char> _message;
+
+	/** The offset of the current data set, or zero if none. */
+	size_t _set_offset = 0;
+
+	/** The template ID of the current data set. */
+	uint16_t _set_id = 0;
+
+	/** Append an unsigned integer in network byte order.
+	 * @param value the value to be appended
+	 * @param size the size of the value, in octets
+	 */
+	void _put(uint64_t value, size_t size);
+
+	/** Overwrite an unsigned integer in network byte order.
+	 * @param offset the offset of the integer
+	 * @param value the value to be written
+	 * @param size the size of the value, in octets
+	 */
+	void _patch(size_t offset, uint32_t value, size_t size);
+
+	/** Start a new message, including the templates if required. */
+	void _begin_message();
+
+	/** Write the template set. */
+	void _write_templates();
+
+	/** End the current data set, if there is one. */
+	void _end_set();
+protected:
+	/** Send a complete message.
+	 * @param data the content of the message
+	 * @param length the length of the message, in octets
+	 */
+	virtual void _send(const unsigned char* data, size_t length) = 0;
+public:
+	/** Construct IPFIX exporter.
+	 * @param max_length the maximum length of a message, in octets
+	 * @param resend_templates true if the templates should be included
+	 *  in every message (as is appropriate for an unreliable transport),
+	 *  or false if only in the first
+	 * @param domain the observation domain ID
+	 */
+	exporter(size_t max_length, bool resend_templates, uint32_t domain = 0);
+
+	virtual ~exporter() = default;
+
+	/** Add a flow.
+	 * @param key the 5-tuple for the flow
+	 * @param info the flow information
+	 */
+	void add(const inet::five_tuple& key, const inet::flow_info& info);
+
+	/** Send any partial message.
+	 * If no message has yet been sent then the templates are sent, even
+	 * if there are no flows.
+	 */
+	void flush();
+};
+
+} /* namespace holmes::net::ipfix */
+
+#endif
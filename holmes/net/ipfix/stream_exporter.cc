@@ -0,0 +1,18 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include "holmes/net/ipfix/stream_exporter.h"
+
+namespace holmes::net::ipfix {
+
+stream_exporter::stream_exporter(std::ostream& out, uint32_t domain):
+	exporter(max_length, false, domain),
+	_out(&out) {}
+
+void stream_exporter::_send(const unsigned char* data, size_t length) {
+	_out->write(reinterpret_cast<const char*>(data), length);
+}
+
+} /* namespace holmes::net::ipfix */
@@ -0,0 +1,40 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_NET_IPFIX_STREAM_EXPORTER
+#define HOLMES_NET_IPFIX_STREAM_EXPORTER
+
+#include <ostream>
+
+#include "holmes/net/ipfix/exporter.h"
+
+namespace holmes::net::ipfix {
+
+/** An IPFIX exporter class for writing messages to an output stream.
+ * This produces an IPFIX file as described by RFC 5655, consisting of
+ * a concatenated sequence of messages. The templates are written only
+ * in the first message.
+ */
+class stream_exporter:
+	public exporter {
+private:
+	/** The stream to receive the messages. */
+	std::ostream* _out;
+protected:
+	void _send(const unsigned char* data, size_t length) override;
+public:
+	/** The maximum length of a message, in octets. */
+	static const size_t max_length = 0xffff;
+
+	/** Construct stream exporter.
+	 * @param out the stream to receive the messages
+	 * @param domain the observation domain ID
+	 */
+	explicit stream_exporter(std::ostream& out, uint32_t domain = 0);
+};
+
+} /* namespace holmes::net::ipfix */
+
+#endif
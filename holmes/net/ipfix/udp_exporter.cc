@@ -0,0 +1,64 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <cerrno>
+#include <stdexcept>
+
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+#include "holmes/libc_error.h"
+#include "holmes/net/ipfix/udp_exporter.h"
+
+namespace holmes::net::ipfix {
+
+udp_exporter::udp_exporter(const std::string& host, const std::string& port,
+	uint32_t domain):
+	exporter(max_length, true, domain) {
+
+	// Resolve the address of the collector.
+	struct addrinfo hints = {};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_DGRAM;
+	struct addrinfo* res = nullptr;
+	int err = getaddrinfo(host.c_str(), port.c_str(), &hints, &res);
+	if (err != 0) {
+		throw std::runtime_error(gai_strerror(err));
+	}
+
+	// Create and connect a socket, trying each address in turn.
+	_fd = -1;
+	int saved_errno = 0;
+	for (struct addrinfo* ai = res; ai; ai = ai->ai_next) {
+		_fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if (_fd == -1) {
+			saved_errno = errno;
+			continue;
+		}
+		if (connect(_fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+			break;
+		}
+		saved_errno = errno;
+		close(_fd);
+		_fd = -1;
+	}
+	freeaddrinfo(res);
+	if (_fd == -1) {
+		throw libc_error(saved_errno);
+	}
+}
+
+udp_exporter::~udp_exporter() {
+	close(_fd);
+}
+
+void udp_exporter::_send(const unsigned char* data, size_t length) {
+	if (send(_fd, data, length, 0) == -1) {
+		throw libc_error();
+	}
+}
+
+} /* namespace holmes::net::ipfix */
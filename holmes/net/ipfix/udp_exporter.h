@@ -0,0 +1,50 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_NET_IPFIX_UDP_EXPORTER
+#define HOLMES_NET_IPFIX_UDP_EXPORTER
+
+#include <string>
+
+#include "holmes/net/ipfix/exporter.h"
+
+namespace holmes::net::ipfix {
+
+/** An IPFIX exporter class for sending messages to a collector by UDP.
+ * Each message is sent as a single datagram. Since UDP is unreliable,
+ * the templates are included in every message, and messages are kept
+ * small enough to avoid IP fragmentation on typical networks.
+ */
+class udp_exporter:
+	public exporter {
+private:
+	/** The file descriptor for the connected socket. */
+	int _fd;
+protected:
+	void _send(const unsigned char* data, size_t length) override;
+public:
+	/** The maximum length of a message, in octets. */
+	static const size_t max_length = 1400;
+
+	/** Construct UDP exporter.
+	 * @param host the hostname or address of the collector
+	 * @param port the port number or service name of the collector
+	 * @param domain the observation domain ID
+	 * @throws std::runtime_error if the collector address cannot
+	 *  be resolved
+	 * @throws libc_error if the socket cannot be created or connected
+	 */
+	udp_exporter(const std::string& host, const std::string& port,
+		uint32_t domain = 0);
+
+	udp_exporter(const udp_exporter&) = delete;
+	udp_exporter& operator=(const udp_exporter&) = delete;
+
+	~udp_exporter();
+};
+
+} /* namespace holmes::net::ipfix */
+
+#endif
@@ -12,7 +12,8 @@ octet::string extract_payload(uint64_t from_seq, uint64_t to_seq,
 
 	octet::string payload;
 	if (segment) {
-		uint32_t offset = from_seq - segment->seq();
+		uint32_t offset = from_seq - segment->seq() -
+			(segment->syn_flag() ? 1 : 0);
 		uint32_t length = to_seq - from_seq;
 		payload = segment->payload().substr(offset, length);
 	}
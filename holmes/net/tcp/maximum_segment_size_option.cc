@@ -3,15 +3,17 @@
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
-#include "holmes/bson/int32.h"
 #include "holmes/net/tcp/maximum_segment_size_option.h"
 
 namespace holmes::net::tcp {
 
-bson::document maximum_segment_size_option::to_bson() const {
-	bson::document result = option::to_bson();
-	result.append("mss", bson::int32(maximum_segment_size()));
-	return result;
+using namespace bson::literals;
+
+void maximum_segment_size_option::_emit_members(bson::emitter& em) const {
+	option::_emit_members(em);
+	if (em.key("mss"_key)) {
+		em.int32(maximum_segment_size());
+	}
 }
 
 std::string maximum_segment_size_option::name() const {
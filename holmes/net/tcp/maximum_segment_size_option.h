@@ -13,14 +13,15 @@ namespace holmes::net::tcp {
 /** A TCP option class to represent a maximum segment size option. */
 class maximum_segment_size_option:
 	public option {
+protected:
+	void _emit_members(bson::emitter& em) const override;
 public:
-	/** Construct TCP no operation option.
+	/** Construct TCP maximum segment size option.
 	 * @param data the raw content of the option
 	 */
 	maximum_segment_size_option(octet::string& data):
 		option(data) {}
 
-	virtual bson::document to_bson() const;
 	virtual std::string name() const;
 
 	/** Get the maximum segment size.
@@ -3,8 +3,6 @@
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
-#include "holmes/bson/int32.h"
-#include "holmes/bson/binary.h"
 #include "holmes/net/tcp/option.h"
 #include "holmes/net/tcp/end_of_option_list.h"
 #include "holmes/net/tcp/no_operation_option.h"
@@ -12,7 +10,7 @@
 
 namespace holmes::net::tcp {
 
-using namespace bson;
+using namespace bson::literals;
 
 option::option(octet::string& data) {
 	uint8_t length = 1;
@@ -30,11 +28,19 @@ option::option(octet::string& data) {
 	_data = read(data, length);
 }
 
-bson::document option::to_bson() const {
-	bson::document bson_option;
-	bson_option.append("type", bson::int32(type()));
-	bson_option.append("payload", bson::binary(payload()));
-	return bson_option;
+void option::_emit_members(bson::emitter& em) const {
+	if (em.key("type"_key)) {
+		em.int32(type());
+	}
+	if (em.key("payload"_key)) {
+		em.binary(payload());
+	}
+}
+
+void option::emit(bson::emitter& em) const {
+	em.begin_document();
+	_emit_members(em);
+	em.end_document();
 }
 
 std::string option::name() const {
@@ -54,4 +60,21 @@ std::unique_ptr<option> option::parse(octet::string& data) {
 	}
 }
 
+void option::describe(bson::emitter& em, octet::string data) {
+	switch (get_uint8(data, 0)) {
+	case 0:
+		end_of_option_list(data).emit(em);
+		break;
+	case 1:
+		no_operation_option(data).emit(em);
+		break;
+	case 2:
+		maximum_segment_size_option(data).emit(em);
+		break;
+	default:
+		option(data).emit(em);
+		break;
+	}
+}
+
 } /* namespace holmes::net::tcp */
@@ -0,0 +1,215 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <algorithm>
+
+#include "holmes/net/tcp/event.h"
+#include "holmes/net/tcp/reassembler.h"
+
+namespace holmes::net::tcp {
+
+reassembler::reassembler(reassembly_policy& policy,
+	octet::stream::listener& listener, size_t flow_limit,
+	reassembly_budget* budget):
+	_policy(&policy),
+	_listener(&listener),
+	_flow_limit(flow_limit),
+	_budget(budget),
+	_buffered(0),
+	_have_client(false),
+	_client_port(0) {
+
+	_halves[0].direction = false;
+	_halves[1].direction = true;
+}
+
+reassembler::~reassembler() {
+	if (_budget) {
+		_budget->remove(_buffered);
+	}
+}
+
+void reassembler::_emplace(half& h, piece_map::iterator hint, uint64_t seq,
+	uint64_t end, const segment& seg) {
+
+	h.pieces.emplace_hint(hint, seq, piece{end, seg});
+	_buffered += end - seq;
+	if (_budget) {
+		_budget->add(end - seq);
+	}
+}
+
+reassembler::piece_map::iterator reassembler::_erase(half& h,
+	piece_map::iterator it) {
+
+	size_t count = it->second.end - it->first;
+	_buffered -= count;
+	if (_budget) {
+		_budget->remove(count);
+	}
+	return h.pieces.erase(it);
+}
+
+void reassembler::_insert(half& h, uint64_t seq, uint64_t end,
+	const segment& seg) {
+
+	// Find the first region which ends after the start of the new content.
+	auto it = h.pieces.upper_bound(seq);
+	if (it != h.pieces.begin()) {
+		auto prev = std::prev(it);
+		if (prev->second.end > seq) {
+			it = prev;
+		}
+	}
+
+	uint64_t pos = seq;
+	while (pos < end) {
+		const segment* prev_seg = (it != h.pieces.begin()) ?
+			&std::prev(it)->second.seg : nullptr;
+		if ((it == h.pieces.end()) || (it->first > pos)) {
+			// No existing content at pos: the region extends up to
+			// the next existing content, or the end of the new content.
+			uint64_t region_end = (it == h.pieces.end()) ?
+				end : std::min(end, it->first);
+			const segment* next_seg = (it != h.pieces.end()) ?
+				&it->second.seg : nullptr;
+			if (_policy->choose(pos, h.curseq, prev_seg, nullptr,
+				next_seg, seg)) {
+
+				_emplace(h, it, pos, region_end, seg);
+			}
+			pos = region_end;
+		} else {
+			// Existing content at pos: the region extends up to the end
+			// of the existing content, or the end of the new content.
+			uint64_t region_end = std::min(end, it->second.end);
+			auto next = std::next(it);
+			const segment* next_seg = (next != h.pieces.end()) ?
+				&next->second.seg : nullptr;
+			if (_policy->choose(pos, h.curseq, prev_seg, &it->second.seg,
+				next_seg, seg)) {
+
+				// Split the existing content around the region, then
+				// replace the region with the new content.
+				uint64_t old_seq = it->first;
+				piece old = it->second;
+				it = _erase(h, it);
+				if (old_seq < pos) {
+					_emplace(h, it, old_seq, pos, old.seg);
+				}
+				if (region_end < old.end) {
+					_emplace(h, it, region_end, old.end, old.seg);
+					--it;
+				}
+				_emplace(h, it, pos, region_end, seg);
+			} else {
+				it = next;
+			}
+			pos = region_end;
+		}
+	}
+}
+
+void reassembler::_deliver(half& h) {
+	while (!h.pieces.empty()) {
+		auto it = h.pieces.begin();
+		if (it->first != h.curseq) {
+			break;
+		}
+		event ev(it->first, it->second.end, &it->second.seg, h.direction);
+		h.curseq = it->second.end;
+		_listener->handle(ev);
+		_erase(h, it);
+	}
+	if (h.finseq && (*h.finseq == h.curseq)) {
+		h.curseq += 1;
+		h.finseq.reset();
+	}
+}
+
+void reassembler::_skip_gap(half& h) {
+	if (h.pieces.empty()) {
+		return;
+	}
+	uint64_t seq = h.pieces.begin()->first;
+	if (seq > h.curseq) {
+		event ev(h.curseq, seq, nullptr, h.direction);
+		h.curseq = seq;
+		_listener->handle(ev);
+	}
+	_deliver(h);
+}
+
+void reassembler::_enforce_limits(half& h) {
+	half& other = _halves[!h.direction];
+	while (_over_limit()) {
+		if (!h.pieces.empty()) {
+			_skip_gap(h);
+		} else if (!other.pieces.empty()) {
+			_skip_gap(other);
+		} else {
+			break;
+		}
+	}
+}
+
+void reassembler::ingest(const inet::datagram& dgram, const segment& seg) {
+	if (!_have_client) {
+		if (seg.syn_flag() && seg.ack_flag()) {
+			_client_addr = dgram.dst_addr();
+			_client_port = seg.dst_port();
+		} else {
+			_client_addr = dgram.src_addr();
+			_client_port = seg.src_port();
+		}
+		_have_client = true;
+	}
+	bool direction = (seg.src_port() == _client_port) &&
+		(dgram.src_addr() == _client_addr);
+	half& h = _halves[direction];
+
+	if (!h.initialised) {
+		h.curseq = seg.seq() + (seg.syn_flag() ? 1 : 0);
+		h.initialised = true;
+	}
+
+	// Determine the range of extended sequence numbers occupied by the
+	// payload. This excludes the SYN flag (if present), which precedes
+	// the payload, and the FIN flag, which follows it.
+	uint64_t seq = seg.seq(h.curseq) + (seg.syn_flag() ? 1 : 0);
+	uint64_t end = seq + seg.payload().length();
+	if (seg.fin_flag() && (end >= h.curseq)) {
+		h.finseq = end;
+	}
+
+	// Discard any content which has already been delivered.
+	seq = std::max(seq, h.curseq);
+	if (seq < end) {
+		if ((seq == h.curseq) && h.pieces.empty()) {
+			// Fast path for content which can be delivered immediately.
+			if (_policy->choose(seq, h.curseq, nullptr, nullptr,
+				nullptr, seg)) {
+
+				event ev(seq, end, &seg, h.direction);
+				h.curseq = end;
+				_listener->handle(ev);
+			}
+		} else {
+			_insert(h, seq, end, seg);
+		}
+	}
+	_deliver(h);
+	_enforce_limits(h);
+}
+
+void reassembler::flush() {
+	for (half& h : _halves) {
+		while (!h.pieces.empty()) {
+			_skip_gap(h);
+		}
+	}
+}
+
+} /* namespace holmes::net::tcp */
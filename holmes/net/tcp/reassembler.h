@@ -0,0 +1,193 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_NET_TCP_REASSEMBLER
+#define HOLMES_NET_TCP_REASSEMBLER
+
+#include <cstdint>
+#include <map>
+#include <optional>
+
+#include "holmes/octet/stream/listener.h"
+#include "holmes/net/inet/address_value.h"
+#include "holmes/net/inet/datagram.h"
+#include "holmes/net/tcp/segment.h"
+#include "holmes/net/tcp/reassembly_policy.h"
+#include "holmes/net/tcp/reassembly_budget.h"
+
+namespace holmes::net::tcp {
+
+/** A class for reassembling the content of a TCP connection.
+ * Segments belonging to a single connection are presented in the order
+ * in which they were captured, and the content of each direction of
+ * travel is delivered in sequence order to a listener as a series of
+ * tcp::event objects. Event payloads refer to the content of the
+ * original segments, so are not copied.
+ *
+ * Content which cannot yet be delivered is held in an interval map,
+ * keyed by extended sequence number, in which no two entries overlap.
+ * Where a new segment overlaps existing content, the reassembly policy
+ * is consulted once for each overlapping region (in ascending order) to
+ * decide which content should be retained.
+ *
+ * The amount of buffered content is limited both per connection and,
+ * optionally, by a budget which is shared between connections. When
+ * either limit is exceeded, the earliest gap is skipped: an event with
+ * no segment is delivered to mark the missing content, followed by any
+ * content which then becomes deliverable.
+ *
+ * The client is taken to be the sender of the first segment seen, unless
+ * that segment has both the SYN and ACK flags set, in which case it is
+ * taken to be the recipient.
+ */
+class reassembler {
+public:
+	/** The default maximum content buffered per connection, in octets. */
+	static const size_t default_flow_limit = 0x100000;
+private:
+	/** A structure to represent a region of buffered content. */
+	struct piece {
+		/** The extended sequence number following this region. */
+		uint64_t end;
+
+		/** The segment which provides the content for this region. */
+		segment seg;
+	};
+
+	/** A type to represent a set of non-overlapping regions,
+	 * keyed by the extended sequence number at which they begin. */
+	typedef std::map<uint64_t, piece> piece_map;
+
+	/** A structure to represent one direction of travel. */
+	struct half {
+		/** The direction: true for client to server, otherwise false. */
+		bool direction;
+
+		/** True if the initial sequence number is known. */
+		bool initialised = false;
+
+		/** The extended sequence number up to which content has
+		 * been delivered. */
+		uint64_t curseq = 0;
+
+		/** The extended sequence number of the FIN, if known. */
+		std::optional<uint64_t> finseq;
+
+		/** The buffered content. */
+		piece_map pieces;
+	};
+
+	/** The reassembly policy. */
+	reassembly_policy* _policy;
+
+	/** The listener to which events are delivered. */
+	octet::stream::listener* _listener;
+
+	/** The maximum content buffered by this reassembler, in octets. */
+	size_t _flow_limit;
+
+	/** The shared budget, or null if none. */
+	reassembly_budget* _budget;
+
+	/** The content buffered by this reassembler, in octets. */
+	size_t _buffered;
+
+	/** True if the client endpoint is known. */
+	bool _have_client;
+
+	/** The client address. */
+	inet::address_value _client_addr;
+
+	/** The client port number. */
+	uint16_t _client_port;
+
+	/** The server to client and client to server directions. */
+	half _halves[2];
+
+	/** Add a region to the buffered content.
+	 * @param h the direction of travel
+	 * @param hint an iterator to the entry which will follow the region
+	 * @param seq the extended sequence number at which the region begins
+	 * @param end the extended sequence number following the region
+	 * @param seg the segment which provides the content
+	 */
+	void _emplace(half& h, piece_map::iterator hint, uint64_t seq,
+		uint64_t end, const segment& seg);
+
+	/** Remove a region from the buffered content.
+	 * @param h the direction of travel
+	 * @param it an iterator to the region to be removed
+	 * @return an iterator to the following region
+	 */
+	piece_map::iterator _erase(half& h, piece_map::iterator it);
+
+	/** Insert content, resolving any overlaps using the policy.
+	 * @param h the direction of travel
+	 * @param seq the extended sequence number at which the content begins
+	 * @param end the extended sequence number following the content
+	 * @param seg the segment which provides the content
+	 */
+	void _insert(half& h, uint64_t seq, uint64_t end, const segment& seg);
+
+	/** Deliver any content which is contiguous with what has already
+	 * been delivered.
+	 * @param h the direction of travel
+	 */
+	void _deliver(half& h);
+
+	/** Skip the earliest gap, then deliver any content which follows it.
+	 * @param h the direction of travel
+	 */
+	void _skip_gap(half& h);
+
+	/** Test whether either the per-connection or shared limit has been
+	 * exceeded.
+	 * @return true if exceeded, otherwise false
+	 */
+	bool _over_limit() const {
+		return (_buffered > _flow_limit) || (_budget && _budget->exceeded());
+	}
+
+	/** Skip gaps until the buffered content is within limits.
+	 * @param h the direction of travel to be skipped first
+	 */
+	void _enforce_limits(half& h);
+public:
+	/** Construct reassembler.
+	 * The policy is shared by both directions of travel.
+	 * @param policy the reassembly policy
+	 * @param listener the listener to which events should be delivered
+	 * @param flow_limit the maximum content to be buffered, in octets
+	 * @param budget a budget shared with other reassemblers, or null
+	 */
+	reassembler(reassembly_policy& policy, octet::stream::listener& listener,
+		size_t flow_limit = default_flow_limit,
+		reassembly_budget* budget = nullptr);
+
+	~reassembler();
+
+	reassembler(const reassembler&) = delete;
+	reassembler& operator=(const reassembler&) = delete;
+
+	/** Ingest a TCP segment.
+	 * @param dgram the IP datagram containing the segment
+	 * @param seg the segment to be ingested
+	 */
+	void ingest(const inet::datagram& dgram, const segment& seg);
+
+	/** Deliver all buffered content, skipping any gaps. */
+	void flush();
+
+	/** Get the amount of buffered content.
+	 * @return the buffered content, in octets
+	 */
+	size_t buffered() const {
+		return _buffered;
+	}
+};
+
+} /* namespace holmes::net::tcp */
+
+#endif
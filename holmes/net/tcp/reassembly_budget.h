@@ -0,0 +1,75 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_NET_TCP_REASSEMBLY_BUDGET
+#define HOLMES_NET_TCP_REASSEMBLY_BUDGET
+
+#include <cstddef>
+
+namespace holmes::net::tcp {
+
+/** A class to limit the total content buffered by a set of reassemblers.
+ * A single budget may be shared by any number of reassemblers. Each one
+ * accounts for the out-of-order content which it is holding, and when
+ * the budget is exceeded, it will skip over gaps in its own streams in
+ * order to release content until the budget is no longer exceeded.
+ */
+class reassembly_budget {
+private:
+	/** The maximum number of octets which may be buffered. */
+	size_t _limit;
+
+	/** The number of octets currently buffered. */
+	size_t _used;
+public:
+	/** Construct reassembly budget.
+	 * @param limit the maximum number of octets which may be buffered
+	 */
+	explicit reassembly_budget(size_t limit):
+		_limit(limit),
+		_used(0) {}
+
+	reassembly_budget(const reassembly_budget&) = delete;
+	reassembly_budget& operator=(const reassembly_budget&) = delete;
+
+	/** Get the maximum number of octets which may be buffered.
+	 * @return the limit, in octets
+	 */
+	size_t limit() const {
+		return _limit;
+	}
+
+	/** Get the number of octets currently buffered.
+	 * @return the number of octets
+	 */
+	size_t used() const {
+		return _used;
+	}
+
+	/** Test whether this budget has been exceeded.
+	 * @return true if exceeded, otherwise false
+	 */
+	bool exceeded() const {
+		return _used > _limit;
+	}
+
+	/** Account for octets which have been buffered.
+	 * @param count the number of octets
+	 */
+	void add(size_t count) {
+		_used += count;
+	}
+
+	/** Account for octets which have been released.
+	 * @param count the number of octets
+	 */
+	void remove(size_t count) {
+		_used -= count;
+	}
+};
+
+} /* namespace holmes::net::tcp */
+
+#endif
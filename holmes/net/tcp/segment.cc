@@ -3,69 +3,109 @@
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
-#include "holmes/bson/boolean.h"
-#include "holmes/bson/int32.h"
-#include "holmes/bson/int64.h"
-#include "holmes/bson/binary.h"
-#include "holmes/bson/array.h"
 #include "holmes/net/inet/checksum.h"
+#include "holmes/net/tcp/option.h"
 #include "holmes/net/tcp/segment.h"
 
 namespace holmes::net::tcp {
 
 using namespace bson;
+using namespace bson::literals;
 
 segment::segment(const inet::datagram& inet_datagram, octet::string& data):
         _phc(inet_datagram.make_pseudo_header_checksum(protocol, data.length())),
 	_data(data) {}
 
-std::unique_ptr<segment::option_list> segment::_make_options() const {
-	octet::string header = _data.substr(0, data_offset() * 4);
-	octet::string option_data = header.substr(20);
-
-	std::unique_ptr<option_list> options = std::make_unique<option_list>();
-	while (!option_data.empty()) {
-		std::unique_ptr<option> opt = option::parse(option_data);
-		bool eool = (opt->type() == 0);
-		options->push_back(std::move(opt));
-		if (eool) {
-			break;
-		}
+std::optional<uint16_t> segment::maximum_segment_size() const {
+	const inet::option_table& table = options();
+	const inet::option_table::entry* e = table.find(2);
+	if (!e || e->length != 4) {
+		return std::nullopt;
 	}
-	return options;
+	return get_uint16(table.data(*e), 2);
 }
 
-bson::document segment::to_bson() const {
-	bson::document bson_checksum;
-	bson_checksum.append("recorded", bson::int32(recorded_checksum()));
-	bson_checksum.append("calculated", bson::int32(calculated_checksum()));
-
-	bson::array bson_options;
-	for (const auto& option : options()) {
-		bson_options.append(option->to_bson());
+std::optional<uint8_t> segment::window_scale() const {
+	const inet::option_table& table = options();
+	const inet::option_table::entry* e = table.find(3);
+	if (!e || e->length != 3) {
+		return std::nullopt;
 	}
+	return get_uint8(table.data(*e), 2);
+}
 
-	bson::document bson_dgram;
-	bson_dgram.append("src_port", bson::int32(src_port()));
-	bson_dgram.append("dst_port", bson::int32(dst_port()));
-	bson_dgram.append("seq", bson::int64(seq()));
-	bson_dgram.append("ack", bson::int64(ack()));
-	bson_dgram.append("flags", bson::int32(flags()));
-	bson_dgram.append("ns_flag", bson::boolean(ns_flag()));
-	bson_dgram.append("cwr_flag", bson::boolean(cwr_flag()));
-	bson_dgram.append("ece_flag", bson::boolean(ece_flag()));
-	bson_dgram.append("urg_flag", bson::boolean(urg_flag()));
-	bson_dgram.append("ack_flag", bson::boolean(ack_flag()));
-	bson_dgram.append("psh_flag", bson::boolean(psh_flag()));
-	bson_dgram.append("rst_flag", bson::boolean(rst_flag()));
-	bson_dgram.append("syn_flag", bson::boolean(syn_flag()));
-	bson_dgram.append("fin_flag", bson::boolean(fin_flag()));
-	bson_dgram.append("window_size", bson::int32(window_size()));
-	bson_dgram.append("checksum", bson_checksum);
-	bson_dgram.append("urgent_pointer", bson::int32(urgent_pointer()));
-	bson_dgram.append("options", bson_options);
-	bson_dgram.append("payload", bson::binary(payload()));
-	return bson_dgram;
+void segment::emit(bson::emitter& em) const {
+	em.begin_document();
+	if (em.key("src_port"_key)) {
+		em.int32(src_port());
+	}
+	if (em.key("dst_port"_key)) {
+		em.int32(dst_port());
+	}
+	if (em.key("seq"_key)) {
+		em.int64(seq());
+	}
+	if (em.key("ack"_key)) {
+		em.int64(ack());
+	}
+	if (em.key("flags"_key)) {
+		em.int32(flags());
+	}
+	if (em.key("ns_flag"_key)) {
+		em.boolean(ns_flag());
+	}
+	if (em.key("cwr_flag"_key)) {
+		em.boolean(cwr_flag());
+	}
+	if (em.key("ece_flag"_key)) {
+		em.boolean(ece_flag());
+	}
+	if (em.key("urg_flag"_key)) {
+		em.boolean(urg_flag());
+	}
+	if (em.key("ack_flag"_key)) {
+		em.boolean(ack_flag());
+	}
+	if (em.key("psh_flag"_key)) {
+		em.boolean(psh_flag());
+	}
+	if (em.key("rst_flag"_key)) {
+		em.boolean(rst_flag());
+	}
+	if (em.key("syn_flag"_key)) {
+		em.boolean(syn_flag());
+	}
+	if (em.key("fin_flag"_key)) {
+		em.boolean(fin_flag());
+	}
+	if (em.key("window_size"_key)) {
+		em.int32(window_size());
+	}
+	if (em.key("checksum"_key)) {
+		em.begin_document();
+		if (em.key("recorded"_key)) {
+			em.int32(recorded_checksum());
+		}
+		if (em.key("calculated"_key)) {
+			em.int32(calculated_checksum());
+		}
+		em.end_document();
+	}
+	if (em.key("urgent_pointer"_key)) {
+		em.int32(urgent_pointer());
+	}
+	if (em.key("options"_key)) {
+		em.begin_array();
+		const inet::option_table& table = options();
+		for (const auto& entry : table) {
+			option::describe(em, table.data(entry));
+		}
+		em.end_array();
+	}
+	if (em.key("payload"_key)) {
+		em.binary(payload());
+	}
+	em.end_document();
 }
 
 uint16_t segment::calculated_checksum() const {
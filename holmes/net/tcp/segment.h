@@ -6,13 +6,12 @@
 #ifndef HOLMES_NET_TCP_SEGMENT
 #define HOLMES_NET_TCP_SEGMENT
 
-#include <memory>
-#include <vector>
+#include <optional>
 
 #include "holmes/octet/string.h"
 #include "holmes/net/inet/datagram.h"
 #include "holmes/net/inet/l4_packet.h"
-#include "holmes/net/tcp/option.h"
+#include "holmes/net/inet/option_table.h"
 
 namespace holmes::net::tcp {
 
@@ -23,22 +22,14 @@ public:
         /** The internet protocol number. */
         static const uint8_t protocol = 6;
 private:
-	/** A type to represent a list of options. */
-	typedef std::vector<std::unique_ptr<option>> option_list;
-
 	/** The pseudo-header checksum. */
 	inet::checksum _phc;
 
 	/** The raw content. */
 	octet::string _data;
 
-	/** The list of options. */
-	mutable std::unique_ptr<option_list> _options;
-
-	/** Make the list of options.
-	 * @return the newly-created list of options
-	 */
-	std::unique_ptr<option_list> _make_options() const;
+	/** The table of options. */
+	mutable std::optional<inet::option_table> _options;
 public:
 	/** Construct TCP segment.
 	 * @param inet_datagram the IP datagram to which this belongs.
@@ -65,7 +56,7 @@ public:
 		return *this;
 	}
 
-	bson::document to_bson() const override;
+	void emit(bson::emitter& em) const override;
 
 	/** Get the source port.
 	 * @return the source port
@@ -136,7 +127,7 @@ public:
 	 * This includes the reserved bits, but not the data offset field.
 	 * @return the flags
 	 */
-	bool flags() const {
+	uint16_t flags() const {
 		return get_uint16(_data, 12) & 0xfff;
 	}
 
@@ -235,16 +226,33 @@ public:
 		return get_uint16(_data, 18);
 	}
 
-	/** Get the list of options.
-	 * @return the list of options
+	/** Get the table of options.
+	 * @return the table of options
 	 */
-	const option_list& options() const {
+	const inet::option_table& options() const {
 		if (!_options) {
-			_options = _make_options();
+			_options.emplace(_data.substr(0, data_offset() * 4).substr(20));
 		}
 		return *_options;
 	}
 
+	/** Get the maximum segment size, if specified.
+	 * @return the maximum segment size, in octets
+	 */
+	std::optional<uint16_t> maximum_segment_size() const;
+
+	/** Get the window scale shift count, if specified.
+	 * @return the shift count
+	 */
+	std::optional<uint8_t> window_scale() const;
+
+	/** Test whether selective acknowledgements are permitted.
+	 * @return true if a SACK-permitted option is present, otherwise false
+	 */
+	bool sack_permitted() const {
+		return options().find(4) != nullptr;
+	}
+
 	/** Get the payload.
 	 * @return the payload
 	 */
@@ -3,15 +3,13 @@
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
-#include "holmes/bson/int32.h"
-#include "holmes/bson/binary.h"
-#include "holmes/bson/document.h"
 #include "holmes/net/inet/checksum.h"
 #include "holmes/net/udp/datagram.h"
 
 namespace holmes::net::udp {
 
 using namespace bson;
+using namespace bson::literals;
 
 datagram::datagram(const inet::datagram& inet_datagram, octet::string& data):
 	_phc(inet_datagram.make_pseudo_header_checksum(protocol, data.length())) {
@@ -28,17 +26,28 @@ datagram::datagram(const inet::datagram& inet_datagram, octet::string& data):
 	_data = read(data, length);
 }
 
-bson::document datagram::to_bson() const {
-	bson::document bson_checksum;
-	bson_checksum.append("recorded", bson::int32(recorded_checksum()));
-	bson_checksum.append("calculated", bson::int32(calculated_checksum()));
-
-	bson::document bson_datagram;
-	bson_datagram.append("src_port", bson::int32(src_port()));
-	bson_datagram.append("dst_port", bson::int32(dst_port()));
-	bson_datagram.append("checksum", bson_checksum);
-	bson_datagram.append("payload", bson::binary(payload()));
-	return bson_datagram;
+void datagram::emit(bson::emitter& em) const {
+	em.begin_document();
+	if (em.key("src_port"_key)) {
+		em.int32(src_port());
+	}
+	if (em.key("dst_port"_key)) {
+		em.int32(dst_port());
+	}
+	if (em.key("checksum"_key)) {
+		em.begin_document();
+		if (em.key("recorded"_key)) {
+			em.int32(recorded_checksum());
+		}
+		if (em.key("calculated"_key)) {
+			em.int32(calculated_checksum());
+		}
+		em.end_document();
+	}
+	if (em.key("payload"_key)) {
+		em.binary(payload());
+	}
+	em.end_document();
 }
 
 uint16_t datagram::calculated_checksum() const {
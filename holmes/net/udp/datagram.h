@@ -31,7 +31,7 @@ public:
 	 */
 	datagram(const inet::datagram& inet_datagram, octet::string& data);
 
-	bson::document to_bson() const override;
+	void emit(bson::emitter& em) const override;
 
 	/** Get the source port.
 	 * @return the source port
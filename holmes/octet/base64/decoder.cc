@@ -1,9 +1,16 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 #include "holmes/parse_error.h"
+#include "holmes/octet/simd.h"
 #include "holmes/octet/base64/decoder.h"
 
 namespace holmes::octet::base64 {
@@ -26,12 +33,176 @@ const int8_t decoder::_charset[0x100] = {
 	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
 	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
 
+#if defined(__x86_64__) || defined(__i386__)
+
+/* The vector implementations below follow the method described by
+ * Wojciech Muła and Daniel Lemire in "Faster Base64 Encoding and Decoding
+ * Using AVX2 Instructions". Characters are classified by looking up their
+ * high and low nibbles in two tables, such that a character is valid if
+ * and only if the bitwise AND of the two results is zero. Valid characters
+ * are then mapped to their 6-bit values by adding an offset, and packed
+ * together using multiply-add instructions.
+ *
+ * A block is decoded only if every character in it belongs to the base64
+ * alphabet. Anything else, including padding, is left to the portable
+ * code so that errors are detected and reported in exactly the same way.
+ */
+
+/** Decode as many complete blocks of 16 characters as possible using
+ * SSSE3, stopping at the first block which is not entirely valid.
+ * Each step writes 16 octets but produces only 12 of them, so the output
+ * buffer must have 4 octets of slack.
+ * @param in the characters to be decoded
+ * @param length the number of characters available
+ * @param out a buffer to receive the octets
+ * @return the number of characters decoded
+ */
+__attribute__((target("ssse3")))
+static size_t decode_ssse3(const char* in, size_t length, unsigned char* out) {
+	const __m128i lut_lo = _mm_setr_epi8(
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+		0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+	const __m128i lut_hi = _mm_setr_epi8(
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+		0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m128i lut_roll = _mm_setr_epi8(
+		0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i mask_0f = _mm_set1_epi8(0x0f);
+
+	size_t done = 0;
+	while (length - done >= 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+		__m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(v, 4), mask_0f);
+		__m128i lo_nibbles = _mm_and_si128(v, mask_0f);
+		__m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+		__m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi),
+			_mm_setzero_si128())) != 0xffff) {
+			break;
+		}
+		__m128i eq_2f = _mm_cmpeq_epi8(v, _mm_set1_epi8(0x2f));
+		__m128i roll = _mm_shuffle_epi8(lut_roll,
+			_mm_add_epi8(eq_2f, hi_nibbles));
+		v = _mm_add_epi8(v, roll);
+
+		v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+		v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+		v = _mm_shuffle_epi8(v, _mm_setr_epi8(
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+		in += 16;
+		out += 12;
+		done += 16;
+	}
+	return done;
+}
+
+/** Decode as many complete blocks of 32 characters as possible using
+ * AVX2, stopping at the first block which is not entirely valid.
+ * Each step writes 32 octets but produces only 24 of them, so the output
+ * buffer must have 8 octets of slack.
+ * @param in the characters to be decoded
+ * @param length the number of characters available
+ * @param out a buffer to receive the octets
+ * @return the number of characters decoded
+ */
+__attribute__((target("avx2")))
+static size_t decode_avx2(const char* in, size_t length, unsigned char* out) {
+	const __m256i lut_lo = _mm256_setr_epi8(
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+		0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+		0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+	const __m256i lut_hi = _mm256_setr_epi8(
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+		0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+		0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m256i lut_roll = _mm256_setr_epi8(
+		0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m256i pack = _mm256_setr_epi8(
+		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	const __m256i mask_0f = _mm256_set1_epi8(0x0f);
+
+	size_t done = 0;
+	while (length - done >= 32) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+		__m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(v, 4), mask_0f);
+		__m256i lo_nibbles = _mm256_and_si256(v, mask_0f);
+		__m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+		__m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+		if (!_mm256_testz_si256(lo, hi)) {
+			break;
+		}
+		__m256i eq_2f = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x2f));
+		__m256i roll = _mm256_shuffle_epi8(lut_roll,
+			_mm256_add_epi8(eq_2f, hi_nibbles));
+		v = _mm256_add_epi8(v, roll);
+
+		v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+		v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+		v = _mm256_shuffle_epi8(v, pack);
+		v = _mm256_permutevar8x32_epi32(v,
+			_mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v);
+		in += 32;
+		out += 24;
+		done += 32;
+	}
+	return done;
+}
+
+#endif
+
+/** Decode as many complete blocks as possible using vector instructions.
+ * The output buffer must have 8 octets of slack.
+ * @param in the characters to be decoded
+ * @param length the number of characters available
+ * @param out a buffer to receive the octets
+ * @return the number of characters decoded, which is a multiple of 4
+ */
+static size_t decode_blocks(const char* in, size_t length,
+	unsigned char* out) {
+
+	size_t done = 0;
+#if defined(__x86_64__) || defined(__i386__)
+	switch (simd_support()) {
+	case simd_level::avx2:
+		done = decode_avx2(in, length, out);
+		if (done == length - length % 32) {
+			done += decode_ssse3(in + done, length - done,
+				out + done / 4 * 3);
+		}
+		break;
+	case simd_level::ssse3:
+		done = decode_ssse3(in, length, out);
+		break;
+	default:
+		break;
+	}
+#endif
+	return done;
+}
+
 octet::string decoder::operator()(const std::string& in) {
 	unsigned int groups = (in.length() + 3) / 4;
 	std::basic_string<unsigned char> out;
 	bool padding = false;
-	out.reserve(groups * 3);
-	for (auto c : in) {
+	out.reserve(groups * 3 + 8);
+
+	// Provided that there are no bits left over from a previous call,
+	// decode as much of the input as possible in blocks. The remainder
+	// (if any) is handled one character at a time.
+	size_t done = 0;
+	if (_count == 0) {
+		out.resize(groups * 3 + 8);
+		done = decode_blocks(in.data(), in.length(), out.data());
+		out.resize(done / 4 * 3);
+	}
+
+	for (auto c : std::string_view(in).substr(done)) {
 		unsigned char uc = c;
 		int8_t v = _charset[uc];
 		if (v >= 0) {
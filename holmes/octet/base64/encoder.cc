@@ -1,8 +1,13 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "holmes/octet/simd.h"
 #include "holmes/octet/base64/encoder.h"
 
 namespace holmes::octet::base64 {
@@ -10,11 +15,174 @@ namespace holmes::octet::base64 {
 const char* encoder::_charset =
 	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+/** Encode complete groups of three octets using portable code.
+ * @param in the octets to be encoded
+ * @param count the number of groups
+ * @param out a buffer to receive four characters per group
+ * @param charset the character set to be used
+ */
+static void encode_scalar(const unsigned char* in, size_t count, char* out,
+	const char* charset) {
+
+	for (size_t i = 0; i != count; ++i) {
+		uint32_t v = (in[0] << 16) | (in[1] << 8) | in[2];
+		out[0] = charset[(v >> 18) & 0x3f];
+		out[1] = charset[(v >> 12) & 0x3f];
+		out[2] = charset[(v >> 6) & 0x3f];
+		out[3] = charset[v & 0x3f];
+		in += 3;
+		out += 4;
+	}
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/* The vector implementations below follow the method described by
+ * Wojciech Muła and Daniel Lemire in "Faster Base64 Encoding and Decoding
+ * Using AVX2 Instructions". Each group of three octets is spread across
+ * four bytes, the four 6-bit indices are moved into place using
+ * multiplications, and the indices are then mapped to ASCII by adding an
+ * offset chosen according to which range of the alphabet they fall in. */
+
+/** Split 12 octets into 16 six-bit indices.
+ * @param in a vector holding the octets in its first 12 bytes
+ * @return the indices, one per byte
+ */
+__attribute__((target("ssse3")))
+static inline __m128i split_ssse3(__m128i in) {
+	in = _mm_shuffle_epi8(in, _mm_setr_epi8(
+		1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+	__m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+	__m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+	__m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+	__m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+	return _mm_or_si128(t1, t3);
+}
+
+/** Map 16 six-bit indices to base64 characters.
+ * @param indices the indices, one per byte
+ * @return the characters
+ */
+__attribute__((target("ssse3")))
+static inline __m128i translate_ssse3(__m128i indices) {
+	__m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+	__m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+	result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+	__m128i offsets = _mm_setr_epi8(
+		'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+		'/' - 63, 'A', 0, 0);
+	return _mm_add_epi8(_mm_shuffle_epi8(offsets, result), indices);
+}
+
+/** Encode as many groups as possible using SSSE3.
+ * Each step reads 16 octets but consumes only 12 of them, so the last
+ * few groups are left for the caller.
+ * @param in the octets to be encoded
+ * @param count the number of groups available
+ * @param out a buffer to receive four characters per group
+ * @return the number of groups encoded
+ */
+__attribute__((target("ssse3")))
+static size_t encode_ssse3(const unsigned char* in, size_t count, char* out) {
+	size_t done = 0;
+	while (count - done >= 6) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+			translate_ssse3(split_ssse3(v)));
+		in += 12;
+		out += 16;
+		done += 4;
+	}
+	return done;
+}
+
+/** Encode as many groups as possible using AVX2.
+ * Each step reads 28 octets but consumes only 24 of them, so the last
+ * few groups are left for the caller.
+ * @param in the octets to be encoded
+ * @param count the number of groups available
+ * @param out a buffer to receive four characters per group
+ * @return the number of groups encoded
+ */
+__attribute__((target("avx2")))
+static size_t encode_avx2(const unsigned char* in, size_t count, char* out) {
+	const __m256i shuffle = _mm256_setr_epi8(
+		1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+		1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+	const __m256i offsets = _mm256_setr_epi8(
+		'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+		'/' - 63, 'A', 0, 0,
+		'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+		'/' - 63, 'A', 0, 0);
+
+	size_t done = 0;
+	while (count - done >= 10) {
+		__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+		__m128i hi = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(in + 12));
+		__m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+		v = _mm256_shuffle_epi8(v, shuffle);
+		__m256i t0 = _mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00));
+		__m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+		__m256i t2 = _mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0));
+		__m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+		__m256i indices = _mm256_or_si256(t1, t3);
+
+		__m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+		__m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+		result = _mm256_or_si256(result,
+			_mm256_and_si256(less, _mm256_set1_epi8(13)));
+		result = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, result), indices);
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), result);
+		in += 24;
+		out += 32;
+		done += 8;
+	}
+	return done;
+}
+
+#endif
+
+/** Encode complete groups of three octets.
+ * The fastest implementation supported by the CPU is used.
+ * @param in the octets to be encoded
+ * @param count the number of groups
+ * @param out a buffer to receive four characters per group
+ * @param charset the character set to be used by the portable code
+ */
+static void encode_groups(const unsigned char* in, size_t count, char* out,
+	const char* charset) {
+
+	size_t done = 0;
+#if defined(__x86_64__) || defined(__i386__)
+	switch (simd_support()) {
+	case simd_level::avx2:
+		done = encode_avx2(in, count, out);
+		done += encode_ssse3(in + done * 3, count - done, out + done * 4);
+		break;
+	case simd_level::ssse3:
+		done = encode_ssse3(in, count, out);
+		break;
+	default:
+		break;
+	}
+#endif
+	encode_scalar(in + done * 3, count - done, out + done * 4, charset);
+}
+
 std::string encoder::operator()(const octet::string& in, bool final) {
 	unsigned int groups = (in.length() + 2) / 3;
 	std::string out;
 	out.reserve(groups * 4);
-	for (auto b : in) {
+
+	const unsigned char* ptr = in.data();
+	size_t remaining = in.length();
+	auto push = [&](unsigned char b) {
 		_buffer <<= 8;
 		_buffer |= b;
 		_count += 8;
@@ -23,7 +191,28 @@ std::string encoder::operator()(const octet::string& in, bool final) {
 			unsigned int i = (_buffer >> _count) & 0x3f;
 			out.push_back(_charset[i]);
 		}
+	};
+
+	// If there are bits left over from a previous call then consume
+	// octets one at a time until they have been flushed, after which
+	// the input can be encoded in complete groups.
+	while ((remaining != 0) && (_count != 0)) {
+		push(*ptr++);
+		remaining -= 1;
 	}
+	size_t count = remaining / 3;
+	if (count != 0) {
+		size_t offset = out.length();
+		out.resize(offset + count * 4);
+		encode_groups(ptr, count, out.data() + offset, _charset);
+		ptr += count * 3;
+		remaining -= count * 3;
+	}
+	while (remaining != 0) {
+		push(*ptr++);
+		remaining -= 1;
+	}
+
 	if (final) {
 		if (_count > 0) {
 			_buffer <<= 8;
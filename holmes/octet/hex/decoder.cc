@@ -3,7 +3,12 @@
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 #include "holmes/parse_error.h"
+#include "holmes/octet/simd.h"
 #include "holmes/octet/hex/decoder.h"
 
 namespace holmes::octet::hex {
@@ -26,15 +31,182 @@ const int8_t decoder::_charset[0x100] = {
 	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
 	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
 
-octet::string decoder::operator()(const std::string& in, bool final) {
-	size_t reserve = in.length() / 2;
-	if ((_count != 0) && (in.length() % 2 != 0)) {
-		reserve += 1;
+#if defined(__x86_64__) || defined(__i386__)
+
+/** Convert 16 hexadecimal digits to their values using SSSE3.
+ * @param v the digits
+ * @param valid set to false if any of the digits are invalid
+ * @return the values, one per byte
+ */
+__attribute__((target("ssse3")))
+static inline __m128i values_ssse3(__m128i v, bool& valid) {
+	__m128i digit = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+	__m128i is_digit = _mm_cmpeq_epi8(
+		_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+	__m128i alpha = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)),
+		_mm_set1_epi8('a'));
+	__m128i is_alpha = _mm_cmpeq_epi8(
+		_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+	if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) != 0xffff) {
+		valid = false;
+	}
+	return _mm_or_si128(_mm_and_si128(is_digit, digit),
+		_mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+}
+
+/** Decode as many blocks of 32 digits as possible using SSSE3,
+ * stopping at the first block which contains anything other than
+ * hexadecimal digits.
+ * @param in the characters to be decoded
+ * @param length the number of characters available
+ * @param out a buffer to receive the octets
+ * @return the number of characters decoded
+ */
+__attribute__((target("ssse3")))
+static size_t decode_ssse3(const char* in, size_t length, unsigned char* out) {
+	// Combine pairs of nibbles by multiplying the first by 16.
+	const __m128i weights = _mm_set1_epi16(0x0110);
+
+	size_t done = 0;
+	while (length - done >= 32) {
+		bool valid = true;
+		__m128i v0 = values_ssse3(_mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(in)), valid);
+		__m128i v1 = values_ssse3(_mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(in + 16)), valid);
+		if (!valid) {
+			break;
+		}
+		v0 = _mm_maddubs_epi16(v0, weights);
+		v1 = _mm_maddubs_epi16(v1, weights);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+			_mm_packus_epi16(v0, v1));
+		in += 32;
+		out += 16;
+		done += 32;
+	}
+	return done;
+}
+
+/** Convert 32 hexadecimal digits to their values using AVX2.
+ * @param v the digits
+ * @param valid set to false if any of the digits are invalid
+ * @return the values, one per byte
+ */
+__attribute__((target("avx2")))
+static inline __m256i values_avx2(__m256i v, bool& valid) {
+	__m256i digit = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+	__m256i is_digit = _mm256_cmpeq_epi8(
+		_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+	__m256i alpha = _mm256_sub_epi8(
+		_mm256_or_si256(v, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+	__m256i is_alpha = _mm256_cmpeq_epi8(
+		_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+	if (~_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_alpha))) {
+		valid = false;
+	}
+	return _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+		_mm256_and_si256(is_alpha,
+			_mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+}
+
+/** Decode as many blocks of 64 digits as possible using AVX2,
+ * stopping at the first block which contains anything other than
+ * hexadecimal digits.
+ * @param in the characters to be decoded
+ * @param length the number of characters available
+ * @param out a buffer to receive the octets
+ * @return the number of characters decoded
+ */
+__attribute__((target("avx2")))
+static size_t decode_avx2(const char* in, size_t length, unsigned char* out) {
+	const __m256i weights = _mm256_set1_epi16(0x0110);
+
+	size_t done = 0;
+	while (length - done >= 64) {
+		bool valid = true;
+		__m256i v0 = values_avx2(_mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(in)), valid);
+		__m256i v1 = values_avx2(_mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(in + 32)), valid);
+		if (!valid) {
+			break;
+		}
+		v0 = _mm256_maddubs_epi16(v0, weights);
+		v1 = _mm256_maddubs_epi16(v1, weights);
+		// Packing operates within each 128-bit lane, so the 64-bit
+		// quarters of the result must be put back into order.
+		__m256i packed = _mm256_permute4x64_epi64(
+			_mm256_packus_epi16(v0, v1), 0xd8);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), packed);
+		in += 64;
+		out += 32;
+		done += 64;
+	}
+	return done;
+}
+
+#endif
+
+/** The number of characters to decode one at a time, after a block has
+ * been rejected, before attempting vector decoding again.
+ * This is the width of the largest block, so that input which is
+ * interspersed with spaces costs at most one rejected block for every
+ * block-width of characters, rather than one at every octet boundary.
+ */
+static const size_t retry_distance = 64;
+
+/** Decode as many blocks of hexadecimal digits as possible using vector
+ * instructions.
+ * @param in the characters to be decoded
+ * @param length the number of characters available
+ * @param out a buffer to receive the octets
+ * @return the number of characters decoded, which is always even
+ */
+static size_t decode_blocks(const char* in, size_t length,
+	unsigned char* out) {
+
+	size_t done = 0;
+#if defined(__x86_64__) || defined(__i386__)
+	switch (simd_support()) {
+	case simd_level::avx2:
+		done = decode_avx2(in, length, out);
+		done += decode_ssse3(in + done, length - done, out + done / 2);
+		break;
+	case simd_level::ssse3:
+		done = decode_ssse3(in, length, out);
+		break;
+	default:
+		break;
 	}
+#endif
+	return done;
+}
+
+octet::string decoder::operator()(const std::string& in, bool final) {
 	std::basic_string<unsigned char> out;
-	out.reserve(reserve);
-	for (auto c : in) {
-		unsigned char uc = c;
+	out.resize(in.length() / 2 + 1);
+	size_t count = 0;
+	size_t index = 0;
+	size_t resume = 0;
+	while (index != in.length()) {
+		// Whenever the input is at an octet boundary, attempt to decode
+		// blocks of digits using vector instructions. If that is not
+		// possible (for example, because the next block contains spaces)
+		// then fall back to decoding one character at a time, and keep
+		// doing so for the width of a block before trying again.
+		if ((_count == 0) && (index >= resume)) {
+			size_t done = decode_blocks(in.data() + index,
+				in.length() - index, out.data() + count);
+			index += done;
+			count += done / 2;
+			if (index == in.length()) {
+				break;
+			}
+			resume = index + retry_distance;
+		}
+
+		unsigned char uc = in[index++];
 		int8_t v = _charset[uc];
 		if (v >= 0) {
 			// Handle substantive content.
@@ -42,7 +214,7 @@ octet::string decoder::operator()(const std::string& in, bool final) {
 			_buffer |= v;
 			_count += 4;
 			if (_count == 8) {
-				out.push_back(_buffer);
+				out[count++] = _buffer;
 				_buffer = 0;
 				_count = 0;
 			}
@@ -53,6 +225,7 @@ octet::string decoder::operator()(const std::string& in, bool final) {
 			throw parse_error("invalid character in hex data");
 		}
 	}
+	out.resize(count);
 
 	if (final && (_count != 0)) {
 		throw parse_error("odd number of digits in hex data");
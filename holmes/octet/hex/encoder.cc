@@ -1,8 +1,13 @@
 // This file is part of libholmes.
-// Copyright 2023 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "holmes/octet/simd.h"
 #include "holmes/octet/hex/encoder.h"
 
 namespace holmes::octet::hex {
@@ -10,12 +15,102 @@ namespace holmes::octet::hex {
 const char* encoder::_charset =
 	"0123456789abcdef";
 
+#if defined(__x86_64__) || defined(__i386__)
+
+/** Encode as many blocks of 16 octets as possible using SSSE3.
+ * Each nibble is mapped to a character using a byte shuffle, with the
+ * character set as the table.
+ * @param in the octets to be encoded
+ * @param length the number of octets available
+ * @param out a buffer to receive two characters per octet
+ * @return the number of octets encoded
+ */
+__attribute__((target("ssse3")))
+static size_t encode_ssse3(const unsigned char* in, size_t length,
+	char* out) {
+
+	const __m128i charset = _mm_loadu_si128(
+		reinterpret_cast<const __m128i*>("0123456789abcdef"));
+	const __m128i mask_0f = _mm_set1_epi8(0x0f);
+
+	size_t done = 0;
+	while (length - done >= 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+		__m128i hi = _mm_shuffle_epi8(charset,
+			_mm_and_si128(_mm_srli_epi16(v, 4), mask_0f));
+		__m128i lo = _mm_shuffle_epi8(charset, _mm_and_si128(v, mask_0f));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+			_mm_unpacklo_epi8(hi, lo));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16),
+			_mm_unpackhi_epi8(hi, lo));
+		in += 16;
+		out += 32;
+		done += 16;
+	}
+	return done;
+}
+
+/** Encode as many blocks of 32 octets as possible using AVX2.
+ * @param in the octets to be encoded
+ * @param length the number of octets available
+ * @param out a buffer to receive two characters per octet
+ * @return the number of octets encoded
+ */
+__attribute__((target("avx2")))
+static size_t encode_avx2(const unsigned char* in, size_t length,
+	char* out) {
+
+	const __m256i charset = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+		reinterpret_cast<const __m128i*>("0123456789abcdef")));
+	const __m256i mask_0f = _mm256_set1_epi8(0x0f);
+
+	size_t done = 0;
+	while (length - done >= 32) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+		__m256i hi = _mm256_shuffle_epi8(charset,
+			_mm256_and_si256(_mm256_srli_epi16(v, 4), mask_0f));
+		__m256i lo = _mm256_shuffle_epi8(charset,
+			_mm256_and_si256(v, mask_0f));
+		// Unpacking operates within each 128-bit lane, so the two halves
+		// of the result must be reassembled across lanes.
+		__m256i a = _mm256_unpacklo_epi8(hi, lo);
+		__m256i b = _mm256_unpackhi_epi8(hi, lo);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+			_mm256_permute2x128_si256(a, b, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32),
+			_mm256_permute2x128_si256(a, b, 0x31));
+		in += 32;
+		out += 64;
+		done += 32;
+	}
+	return done;
+}
+
+#endif
+
 std::string encoder::operator()(const octet::string& in) {
 	std::string out;
-	out.reserve(in.length() * 2);
-	for (auto b : in) {
-		out.push_back(_charset[(b >> 4) & 0xf]);
-		out.push_back(_charset[(b >> 0) & 0xf]);
+	out.resize(in.length() * 2);
+	const unsigned char* ptr = in.data();
+	char* optr = out.data();
+	size_t done = 0;
+#if defined(__x86_64__) || defined(__i386__)
+	switch (simd_support()) {
+	case simd_level::avx2:
+		done = encode_avx2(ptr, in.length(), optr);
+		done += encode_ssse3(ptr + done, in.length() - done, optr + done * 2);
+		break;
+	case simd_level::ssse3:
+		done = encode_ssse3(ptr, in.length(), optr);
+		break;
+	default:
+		break;
+	}
+#endif
+	for (size_t i = done; i != in.length(); ++i) {
+		unsigned char b = ptr[i];
+		optr[i * 2] = _charset[(b >> 4) & 0xf];
+		optr[i * 2 + 1] = _charset[(b >> 0) & 0xf];
 	}
 	return out;
 }
@@ -1,5 +1,5 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
@@ -16,21 +16,26 @@
 namespace holmes::octet::pattern {
 
 any::any(const bson::value& bson_pattern) {
-	if (bson_pattern.is<bson::document>()) {
-		const auto& document = bson_pattern.as<bson::document>();
-		std::string type(document.at("type"));
-		if (type == "fixed") {
-			_pattern = std::make_unique<pattern::fixed>(document);
-		} else if (type == "timeval") {
-			_pattern = std::make_unique<pattern::timeval>(document);
-		} else if (type == "wildcard") {
-			_pattern = std::make_unique<pattern::wildcard>(document);
-		} else {
-			throw parse_error("unrecognised pattern type");
+	switch (bson_pattern.type()) {
+	case bson::document::type_code:
+		{
+			const auto& document = bson_pattern.as<bson::document>();
+			std::string type(document.at("type"));
+			if (type == "fixed") {
+				_pattern = std::make_unique<pattern::fixed>(document);
+			} else if (type == "timeval") {
+				_pattern = std::make_unique<pattern::timeval>(document);
+			} else if (type == "wildcard") {
+				_pattern = std::make_unique<pattern::wildcard>(document);
+			} else {
+				throw parse_error("unrecognised pattern type");
+			}
 		}
-	} else if (bson_pattern.is<bson::array>()) {
+		break;
+	case bson::array::type_code:
 		_pattern = std::make_unique<pattern::sequence>(bson_pattern.as<bson::array>());
-	} else {
+		break;
+	default:
 		throw parse_error("invalid BSON type for octet pattern.");
 	}
 }
@@ -0,0 +1,43 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <atomic>
+
+#include "holmes/octet/simd.h"
+
+namespace holmes::octet {
+
+/** Detect the level of vector support provided by the CPU.
+ * @return the level of vector support
+ */
+static simd_level detect_simd() {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return simd_level::avx2;
+	}
+	if (__builtin_cpu_supports("ssse3")) {
+		return simd_level::ssse3;
+	}
+#endif
+	return simd_level::scalar;
+}
+
+/** The level of vector support provided by the CPU. */
+static const simd_level detected = detect_simd();
+
+/** The level of vector support to be used. */
+static std::atomic<simd_level> selected = detected;
+
+simd_level simd_support() {
+	return selected.load(std::memory_order_relaxed);
+}
+
+void limit_simd(simd_level level) {
+	selected.store((level < detected) ? level : detected,
+		std::memory_order_relaxed);
+}
+
+} /* namespace holmes::octet */
@@ -0,0 +1,39 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#ifndef HOLMES_OCTET_SIMD
+#define HOLMES_OCTET_SIMD
+
+namespace holmes::octet {
+
+/** An enumeration of the vector instruction set extensions which can be
+ * used by the octet codecs, in increasing order of capability. */
+enum class simd_level {
+	/** No vector instructions: use portable code only. */
+	scalar,
+	/** SSSE3, with 128-bit vectors. */
+	ssse3,
+	/** AVX2, with 256-bit vectors. */
+	avx2
+};
+
+/** Get the level of vector support to be used.
+ * This is the highest level supported by the CPU, as detected at run
+ * time, unless a lower limit has been set.
+ * @return the level of vector support
+ */
+simd_level simd_support();
+
+/** Limit the level of vector support to be used.
+ * This is intended for testing and benchmarking, so that each code path
+ * can be exercised on a CPU which supports them all. A limit above the
+ * level supported by the CPU has no effect.
+ * @param level the maximum level to be used
+ */
+void limit_simd(simd_level level);
+
+} /* namespace holmes::octet */
+
+#endif
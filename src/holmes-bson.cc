@@ -0,0 +1,137 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <getopt.h>
+
+#include "holmes/octet/file.h"
+#include "holmes/bson/view.h"
+#include "holmes/bson/json_emitter.h"
+#include "holmes/bson/projection.h"
+
+using namespace holmes;
+
+void write_help(std::ostream& out) {
+	out << "Usage: holmes-bson <pathname> ..." << std::endl;
+	out << std::endl;
+	out << "Convert streams of binary BSON documents, as written by" << std::endl;
+	out << "holmes-decode -B, to JSON with one document per line." << std::endl;
+	out << std::endl;
+	out << "Options:" << std::endl;
+	out << std::endl;
+	out << "  -f  output only the listed fields (for example tcp.dst_port)" << std::endl;
+	out << "  -j  join output into single JSON array" << std::endl;
+}
+
+/** Split a comma-separated list of fields.
+ * @param list the list to be split
+ * @return the fields, excluding any which are empty
+ */
+std::vector<std::string> split_fields(const std::string& list) {
+	std::vector<std::string> fields;
+	size_t start = 0;
+	while (start <= list.length()) {
+		size_t end = list.find(',', start);
+		if (end == std::string::npos) {
+			end = list.length();
+		}
+		if (end != start) {
+			fields.push_back(list.substr(start, end - start));
+		}
+		start = end + 1;
+	}
+	return fields;
+}
+
+/** Convert a stream of BSON documents to JSON.
+ * Each document is read in place using a bson::view, so nothing is
+ * decoded into a tree and members excluded by the projection (if there
+ * is one) are skipped without being decoded.
+ * @param pathname the pathname of the file containing the documents
+ * @param fields the fields to be output, or empty for all fields
+ * @param join true to join the output into a single JSON array
+ * @param first true if no document has yet been written, updated to
+ *  false once one has
+ */
+void convert(const std::string& pathname,
+	const std::vector<std::string>& fields, bool join, bool& first) {
+
+	octet::string bd = octet::file(pathname);
+	std::string out;
+	while (!bd.empty()) {
+		bson::view doc(bd);
+		out.clear();
+		if (join) {
+			if (first) {
+				first = false;
+			} else {
+				out.push_back(',');
+			}
+		}
+		bson::json_emitter em(out);
+		if (fields.empty()) {
+			doc.emit(em);
+		} else {
+			bson::projection proj(em, fields);
+			doc.emit(proj);
+		}
+		if (!join) {
+			out.push_back('\n');
+		}
+		std::cout << out;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	bool join = false;
+	std::vector<std::string> fields;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "f:hj")) != -1) {
+		switch (opt) {
+		case 'f':
+			{
+				std::vector<std::string> more = split_fields(optarg);
+				fields.insert(fields.end(), more.begin(), more.end());
+			}
+			break;
+		case 'h':
+			write_help(std::cout);
+			return 0;
+		case 'j':
+			join = true;
+			break;
+		}
+	}
+
+	if (optind == argc) {
+		std::cerr << "BSON file pathname not specified" << std::endl;
+		exit(1);
+	}
+
+	if (join) {
+		std::cout << '[';
+	}
+	try {
+		bool first = true;
+		while (optind != argc) {
+			std::string pathname = argv[optind++];
+			convert(pathname, fields, join, first);
+		}
+	} catch (std::exception& ex) {
+		std::cout.flush();
+		std::cerr << ex.what() << std::endl;
+		exit(1);
+	}
+	if (join) {
+		std::cout << ']';
+	}
+	return 0;
+}
@@ -1,10 +1,13 @@
 // This file is part of libholmes.
-// Copyright 2021 Graham Shaw.
+// Copyright 2021-23 Graham Shaw.
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
 #include <cstdlib>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include <getopt.h>
 
@@ -13,75 +16,435 @@
 #include "holmes/octet/base64/decoder.h"
 #include "holmes/octet/hex/decoder.h"
 #include "holmes/pcap/file.h"
+#include "holmes/bson/writer.h"
+#include "holmes/bson/json_emitter.h"
+#include "holmes/bson/bson_emitter.h"
+#include "holmes/bson/projection.h"
+#include "holmes/bson/file_reference.h"
+#include "holmes/arrow/column.h"
+#include "holmes/arrow/row_emitter.h"
+#include "holmes/arrow/stream_writer.h"
+#include "holmes/net/filter.h"
 #include "holmes/net/decoder.h"
 #include "holmes/net/ethernet/frame.h"
 
 using namespace holmes;
+using namespace holmes::bson::literals;
 
 void write_help(std::ostream& out) {
 	out << "Usage: holmes-decode <pathname>" << std::endl;
 	out << std::endl;
 	out << "Options:" << std::endl;
 	out << std::endl;
+	out << "  -A  write an Arrow IPC stream of selected header fields" << std::endl;
 	out << "  -b  specify literal base64 data to be decoded" << std::endl;
+	out << "  -B  write a stream of binary BSON documents" << std::endl;
+	out << "  -f  output only the listed fields (for example tcp.dst_port)" << std::endl;
+	out << "  -F  decode only packets which match a filter expression" << std::endl;
 	out << "  -j  join output into single JSON array" << std::endl;
+	out << "  -R  output payloads as references into the capture file" << std::endl;
 	out << "  -x  specify literal hexadecimal data to be decoded" << std::endl;
 }
 
-class bson_decoder final:
+class emitting_decoder final:
 	public net::decoder {
 private:
-	bson::document* _out;
+	bson::emitter* _em;
 protected:
 	void handle_artefact(const std::string& protocol,
 		const artefact& af) override;
 public:
-	explicit bson_decoder(bson::document& out):
-		_out(&out) {}
+	explicit emitting_decoder(bson::emitter& em):
+		_em(&em) {}
 };
 
-void bson_decoder::handle_artefact(const std::string& protocol,
+void emitting_decoder::handle_artefact(const std::string& protocol,
 	const artefact& af) {
 
-	_out->append(protocol, af.to_bson());
+	if (_em->key(protocol)) {
+		af.emit(*_em);
+	}
+}
+
+/** An enumeration of the supported output formats. */
+enum class output_format {
+	/** One JSON document per line. */
+	json,
+	/** A single JSON array containing one document per frame. */
+	json_array,
+	/** A concatenated stream of binary BSON documents. */
+	bson,
+	/** An Arrow IPC stream of header fields, one row per frame. */
+	arrow
+};
+
+/** A structure to hold the options which affect the content of each
+ * document. */
+struct content_options {
+	/** The fields to be output, or empty for all fields. */
+	std::vector<std::string> fields;
+
+	/** True if payloads should be output as references into the capture
+	 * file, where possible, rather than as binary strings. */
+	bool by_reference = false;
+
+	/** The pathname of the capture file, if there is one. */
+	std::string pathname;
+
+	/** The content of the capture file, if there is one. */
+	octet::string file;
+};
+
+/** The amount of BSON to accumulate before writing it out, in octets. */
+const size_t bson_flush_size = 0x10000;
+
+/** A structure to describe a column of the Arrow output. */
+struct arrow_field {
+	/** The name of the column. */
+	const char* name;
+
+	/** The type of the column. */
+	arrow::data_type type;
+
+	/** The member paths which feed the column, in order of preference. */
+	std::vector<std::string> paths;
+};
+
+/** The schema for Arrow output.
+ * The timestamp and length columns are taken from the PCAP record, and
+ * the remainder from the decoded headers. Where a field could come from
+ * more than one protocol, the alternatives feed a single column.
+ */
+const arrow_field arrow_schema[] = {
+	{"timestamp", arrow::data_type::timestamp, {"timestamp"}},
+	{"length", arrow::data_type::uint32, {"length"}},
+	{"eth_src", arrow::data_type::utf8, {"ethernet.src_addr"}},
+	{"eth_dst", arrow::data_type::utf8, {"ethernet.dst_addr"}},
+	{"ethertype", arrow::data_type::uint16, {"ethernet.ethertype"}},
+	{"ip_version", arrow::data_type::uint8,
+		{"inet4.version", "inet6.version"}},
+	{"src_addr", arrow::data_type::utf8,
+		{"inet4.src_addr", "inet6.src_addr"}},
+	{"dst_addr", arrow::data_type::utf8,
+		{"inet4.dst_addr", "inet6.dst_addr"}},
+	{"protocol", arrow::data_type::uint8,
+		{"inet4.protocol", "inet6.next_header"}},
+	{"ttl", arrow::data_type::uint8, {"inet4.ttl", "inet6.hop_limit"}},
+	{"src_port", arrow::data_type::uint16, {"tcp.src_port", "udp.src_port"}},
+	{"dst_port", arrow::data_type::uint16, {"tcp.dst_port", "udp.dst_port"}},
+	{"tcp_flags", arrow::data_type::uint16, {"tcp.flags"}},
+	{"tcp_seq", arrow::data_type::uint32, {"tcp.seq"}},
+	{"tcp_ack", arrow::data_type::uint32, {"tcp.ack"}},
+	{"tcp_window", arrow::data_type::uint16, {"tcp.window_size"}},
+	{"icmp_type", arrow::data_type::uint8, {"icmp4.type"}},
+	{"icmp_code", arrow::data_type::uint8, {"icmp4.code"}}};
+
+/** The number of rows in each Arrow record batch. */
+const size_t arrow_batch_size = 16384;
+
+/** A class for writing decoded frames as an Arrow IPC stream.
+ * Rows are accumulated in columnar form, and written out as a record
+ * batch whenever arrow_batch_size rows have been collected.
+ */
+class arrow_output {
+private:
+	/** The columns of the current record batch. */
+	std::vector<arrow::column> _columns;
+
+	/** An emitter for appending rows to the columns. */
+	arrow::row_emitter _rows;
+
+	/** A projection for selecting the members which feed the columns. */
+	std::optional<bson::projection> _proj;
+
+	/** The writer for the IPC stream. */
+	arrow::stream_writer _writer;
+
+	/** Write any accumulated rows as a record batch. */
+	void _flush();
+public:
+	/** Construct Arrow output, and write the schema.
+	 * @param out the stream to receive the output
+	 */
+	explicit arrow_output(std::ostream& out);
+
+	/** Decode an Ethernet frame as a row.
+	 * If decoding fails then the columns are left unchanged, so that
+	 * they never contain a partial row.
+	 * @param frame the raw content of the frame
+	 * @param ts the capture timestamp, or null if not known
+	 * @param length the original length of the frame, in octets
+	 */
+	void decode(const octet::string& frame, const struct timeval* ts,
+		size_t length);
+
+	/** Write any remaining rows, followed by the end-of-stream marker. */
+	void close();
+};
+
+/** Make an empty set of columns matching the Arrow schema.
+ * @return the columns
+ */
+std::vector<arrow::column> make_arrow_columns() {
+	std::vector<arrow::column> columns;
+	for (const arrow_field& field : arrow_schema) {
+		columns.emplace_back(field.name, field.type);
+	}
+	return columns;
+}
+
+arrow_output::arrow_output(std::ostream& out):
+	_columns(make_arrow_columns()),
+	_rows(_columns),
+	_writer(out, _columns) {
+
+	for (size_t i = 0; i != _columns.size(); ++i) {
+		for (const std::string& path : arrow_schema[i].paths) {
+			_rows.map(path, i);
+		}
+	}
+	_proj.emplace(_rows, _rows.paths());
+}
+
+void arrow_output::_flush() {
+	if (_columns.front().length()) {
+		_writer.write(_columns);
+		for (arrow::column& col : _columns) {
+			col.clear();
+		}
+	}
+}
+
+void arrow_output::decode(const octet::string& frame,
+	const struct timeval* ts, size_t length) {
+
+	// Every column has the same length between rows.
+	size_t rows = _columns.front().length();
+	try {
+		_proj->begin_document();
+		if (ts && _proj->key("timestamp"_key)) {
+			_proj->int64(int64_t(ts->tv_sec) * 1000000 + ts->tv_usec);
+		}
+		if (_proj->key("length"_key)) {
+			_proj->int64(length);
+		}
+		emitting_decoder decoder(*_proj);
+		decoder.decode_ethernet(frame);
+		_proj->end_document();
+	} catch (...) {
+		for (arrow::column& col : _columns) {
+			col.truncate(rows);
+		}
+		_rows.reset();
+		_proj.emplace(_rows, _rows.paths());
+		throw;
+	}
+
+	if (_columns.front().length() >= arrow_batch_size) {
+		_flush();
+	}
+}
+
+void arrow_output::close() {
+	_flush();
+	_writer.close();
 }
 
-void decode_data(const octet::string& data) {
-	bson::document result;
-	bson_decoder decoder(result);
-	decoder.decode_ethernet(data);
-	std::cout << result.to_json() << "\n";
+/** Decode an Ethernet frame as a single document.
+ * @param em the emitter to receive the document
+ * @param frame the raw content of the frame
+ */
+void emit_frame(bson::emitter& em, const octet::string& frame) {
+	em.begin_document();
+	emitting_decoder decoder(em);
+	decoder.decode_ethernet(frame);
+	em.end_document();
 }
 
-void decode_pcap(const std::string& pathname, bool join) {
+/** Decode an Ethernet frame as a single document.
+ * Projection and payload references are applied as requested.
+ * @param em the emitter to receive the document
+ * @param frame the raw content of the frame
+ * @param content the options which affect the content of the document
+ */
+void decode_frame(bson::emitter& em, const octet::string& frame,
+	const content_options& content) {
+
+	bson::emitter* out = &em;
+	std::optional<bson::file_reference> ref;
+	if (content.by_reference && content.file.length()) {
+		ref.emplace(*out, content.pathname, content.file);
+		out = &*ref;
+	}
+	std::optional<bson::projection> proj;
+	if (!content.fields.empty()) {
+		proj.emplace(*out, content.fields);
+		out = &*proj;
+	}
+	emit_frame(*out, frame);
+}
+
+/** Decode an Ethernet frame as a JSON document.
+ * @param out the buffer to receive the JSON
+ * @param frame the raw content of the frame
+ * @param content the options which affect the content of the document
+ */
+void decode_frame(std::string& out, const octet::string& frame,
+	const content_options& content) {
+
+	bson::json_emitter em(out);
+	decode_frame(em, frame, content);
+}
+
+/** Decode an Ethernet frame as a BSON document.
+ * If decoding fails then the content of the writer is left unchanged,
+ * so that it never contains a partial document.
+ * @param bw the writer to receive the BSON
+ * @param frame the raw content of the frame
+ * @param content the options which affect the content of the document
+ */
+void decode_frame(bson::writer& bw, const octet::string& frame,
+	const content_options& content) {
+
+	size_t start = bw.size();
+	try {
+		bson::bson_emitter em(bw);
+		decode_frame(em, frame, content);
+	} catch (...) {
+		bw.truncate(start);
+		throw;
+	}
+}
+
+/** Select the output format.
+ * The output format options are mutually exclusive, so it is an error
+ * for a different format to have been selected already.
+ * @param format the output format variable
+ * @param selected the format to be selected
+ */
+void select_format(output_format& format, output_format selected) {
+	if (format != output_format::json && format != selected) {
+		std::cerr << "options -A, -B and -j are mutually exclusive" <<
+			std::endl;
+		std::exit(1);
+	}
+	format = selected;
+}
+
+/** Split a comma-separated list of fields.
+ * @param list the list to be split
+ * @return the fields, excluding any which are empty
+ */
+std::vector<std::string> split_fields(const std::string& list) {
+	std::vector<std::string> fields;
+	size_t start = 0;
+	while (start <= list.length()) {
+		size_t end = list.find(',', start);
+		if (end == std::string::npos) {
+			end = list.length();
+		}
+		if (end != start) {
+			fields.push_back(list.substr(start, end - start));
+		}
+		start = end + 1;
+	}
+	return fields;
+}
+
+/** Write the content of a BSON writer to standard output.
+ * The writer is cleared afterwards, but retains its capacity.
+ * @param bw the writer to be flushed
+ */
+void flush_bson(bson::writer& bw) {
+	std::cout.write(reinterpret_cast<const char*>(bw.data()), bw.size());
+	bw.clear();
+}
+
+void decode_data(const octet::string& data, output_format format,
+	const std::optional<net::filter>& filter,
+	const content_options& content) {
+
+	if (filter && !(*filter)(data)) {
+		return;
+	}
+	if (format == output_format::arrow) {
+		arrow_output ao(std::cout);
+		ao.decode(data, nullptr, data.length());
+		ao.close();
+	} else if (format == output_format::bson) {
+		bson::writer bw;
+		decode_frame(bw, data, content);
+		flush_bson(bw);
+	} else {
+		std::string out;
+		decode_frame(out, data, content);
+		out.push_back('\n');
+		std::cout << out;
+	}
+}
+
+void decode_pcap(const std::string& pathname, output_format format,
+	const std::optional<net::filter>& filter,
+	const content_options& content) {
+
+	bool join = (format == output_format::json_array);
 	if (join) {
 		std::cout << '[';
 	}
 
 	bool first = true;
+	std::string out;
+	bson::writer bw;
+	std::optional<arrow_output> ao;
+	if (format == output_format::arrow) {
+		ao.emplace(std::cout);
+	}
 	try {
 		octet::file file(pathname);
 		pcap::file pf(file);
+		content_options local = content;
+		local.pathname = pathname;
+		local.file = file;
 
 		while (true) {
-			bson::document result;
-			bson_decoder decoder(result);
-			decoder.decode_ethernet(pf.read().payload());
+			pcap::record rec = pf.read();
+			const octet::string& frame = rec.payload();
+			if (filter && !(*filter)(frame)) {
+				continue;
+			}
+			if (ao) {
+				struct timeval ts = rec.ts();
+				ao->decode(frame, &ts, rec.orig_len());
+				continue;
+			}
+			if (format == output_format::bson) {
+				decode_frame(bw, frame, local);
+				if (bw.size() >= bson_flush_size) {
+					flush_bson(bw);
+				}
+				continue;
+			}
+			out.clear();
 			if (join) {
 				if (first) {
 					first = false;
 				} else {
-					std::cout << ',';
+					out.push_back(',');
 				}
 			}
-			std::cout << result.to_json();
+			decode_frame(out, frame, local);
 			if (!join) {
-				std::cout << '\n';
+				out.push_back('\n');
 			}
+			std::cout << out;
 		}
 	} catch (std::out_of_range&) {
 		/** No action. */
 	}
+	flush_bson(bw);
+	if (ao) {
+		ao->close();
+	}
 
 	if (join) {
 		std::cout << ']';
@@ -89,13 +452,18 @@ void decode_pcap(const std::string& pathname, bool join) {
 }
 
 int main(int argc, char* argv[]) {
-	bool join = false;
+	output_format format = output_format::json;
 	bool from_file = true;
 	octet::string data;
+	std::optional<net::filter> filter;
+	content_options content;
 
 	int opt;
-	while ((opt = getopt(argc, argv, "b:jx:")) != -1) {
+	while ((opt = getopt(argc, argv, "Ab:Bf:F:jRx:")) != -1) {
 		switch (opt) {
+		case 'A':
+			select_format(format, output_format::arrow);
+			break;
 		case 'b':
 			{
 				octet::base64::decoder base64_decoder;
@@ -103,8 +471,29 @@ int main(int argc, char* argv[]) {
 			}
 			from_file = false;
 			break;
+		case 'B':
+			select_format(format, output_format::bson);
+			break;
+		case 'f':
+			{
+				std::vector<std::string> more = split_fields(optarg);
+				content.fields.insert(content.fields.end(),
+					more.begin(), more.end());
+			}
+			break;
+		case 'F':
+			try {
+				filter.emplace(optarg);
+			} catch (std::exception& ex) {
+				std::cerr << ex.what() << std::endl;
+				std::exit(1);
+			}
+			break;
 		case 'j':
-			join = true;
+			select_format(format, output_format::json_array);
+			break;
+		case 'R':
+			content.by_reference = true;
 			break;
 		case 'x':
 			{
@@ -116,6 +505,13 @@ int main(int argc, char* argv[]) {
 		}
 	}
 
+	// The content of Arrow output is fixed by its schema.
+	if (format == output_format::arrow &&
+		(!content.fields.empty() || content.by_reference)) {
+		std::cerr << "options -f and -R cannot be used with -A" << std::endl;
+		std::exit(1);
+	}
+
 	try {
 		if (from_file) {
 			if (optind == argc) {
@@ -123,9 +519,9 @@ int main(int argc, char* argv[]) {
 				std::exit(1);
 			}
 			std::string pathname = argv[optind++];
-			decode_pcap(pathname, join);
+			decode_pcap(pathname, format, filter, content);
 		} else {
-			decode_data(data);
+			decode_data(data, format, filter, content);
 		}
 	} catch (std::exception& ex) {
 		std::cerr << ex.what() << std::endl;
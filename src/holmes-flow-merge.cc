@@ -0,0 +1,58 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <cstdlib>
+#include <iostream>
+
+#include <getopt.h>
+
+#include "holmes/octet/file.h"
+#include "holmes/net/inet/flow_file.h"
+#include "holmes/net/inet/flow_merger.h"
+
+using namespace holmes;
+using namespace holmes::net;
+
+void write_help(std::ostream& out) {
+	out << "Usage: holmes-flow-merge <pathname> ..." << std::endl;
+	out << std::endl;
+	out << "Merge binary flow-record files, as written by holmes-flow -B," << std::endl;
+	out << "into a single flow-record file written to standard output." << std::endl;
+	out << "Records for the same 5-tuple are combined." << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+	int opt;
+	while ((opt = getopt(argc, argv, "h")) != -1) {
+		switch (opt) {
+		case 'h':
+			write_help(std::cout);
+			return 0;
+		}
+	}
+
+	if (optind == argc) {
+		std::cerr << "Flow-record file pathname not specified" << std::endl;
+		exit(1);
+	}
+
+	try {
+		inet::flow_merger merger;
+		while (optind != argc) {
+			std::string pathname = argv[optind++];
+			merger.add(octet::file(pathname));
+		}
+		inet::flow_file_writer writer(std::cout);
+		merger.merge([&writer](const inet::five_tuple& key,
+			const inet::flow_info& info) {
+			writer.write(key, info);
+		});
+		std::cout.flush();
+	} catch (std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+		exit(1);
+	}
+	return 0;
+}
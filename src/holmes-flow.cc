@@ -3,11 +3,22 @@
 // Distribution and modification are permitted within the terms of the
 // GNU General Public License (version 3 or any later version).
 
+#include <charconv>
+#include <cstdint>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
 
 #include <getopt.h>
 
+#include "holmes/bson/int32.h"
+#include "holmes/bson/int64.h"
+#include "holmes/bson/document.h"
 #include "holmes/octet/string.h"
 #include "holmes/octet/file.h"
 #include "holmes/pcap/file.h"
@@ -16,6 +27,9 @@
 #include "holmes/net/tcp/segment.h"
 #include "holmes/net/udp/datagram.h"
 #include "holmes/net/inet/flow_table.h"
+#include "holmes/net/ipfix/stream_exporter.h"
+#include "holmes/net/ipfix/udp_exporter.h"
+#include "holmes/net/filter.h"
 #include "holmes/net/decoder.h"
 
 using namespace holmes;
@@ -26,6 +40,11 @@ void write_help(std::ostream& out) {
 	out << std::endl;
 	out << "Options:" << std::endl;
 	out << std::endl;
+	out << "  -B  write the flow table as a binary flow-record file" << std::endl;
+	out << "  -F  ingest only packets which match a filter expression" << std::endl;
+	out << "  -I  export the flow table as IPFIX to a file or udp://host:port" << std::endl;
+	out << "  -M  limit the flow table to a memory budget in MiB, spilling" << std::endl;
+	out << "      sorted runs to disk (in TMPDIR) when it is exceeded" << std::endl;
 	out << "  -j  join output into single JSON array" << std::endl;
 }
 
@@ -33,12 +52,32 @@ class flow_table_decoder final:
 	public net::decoder {
 private:
 	net::inet::flow_table _flows;
+
+	/** The capture timestamp of the frame being decoded. */
+	struct timeval _ts = {};
+
+	/** An optional filter for selecting which packets to ingest. */
+	std::optional<net::filter> _filter;
 protected:
 	void handle_tcp(const inet::datagram& inet_dgram,
 		const tcp::segment& tcp_seg) override;
 public:
+	/** Construct flow table decoder.
+	 * @param filter an optional filter for selecting packets
+	 * @param flows the flow table to be populated
+	 */
+	flow_table_decoder(const std::optional<net::filter>& filter,
+		net::inet::flow_table&& flows):
+		_flows(std::move(flows)),
+		_filter(filter) {}
+
 	void decode(const std::string& pathname);
 
+	/** Finalise all connections remaining in the flow table. */
+	void finalise() {
+		_flows.finalise();
+	}
+
 	const net::inet::flow_table& flows() const {
 		return _flows;
 	}
@@ -47,7 +86,7 @@ public:
 void flow_table_decoder::handle_tcp(const inet::datagram& inet_dgram,
 	const tcp::segment& tcp_seg) {
 
-	_flows.ingest(inet_dgram, tcp_seg);
+	_flows.ingest(_ts, inet_dgram, tcp_seg);
 }
 
 void flow_table_decoder::decode(const std::string& pathname) {
@@ -56,37 +95,185 @@ void flow_table_decoder::decode(const std::string& pathname) {
 		pcap::file pf(file);
 
 		while (true) {
-			decode_ethernet(pf.read().payload());
+			pcap::record rec = pf.read();
+			octet::string frame = rec.payload();
+			if (_filter && !(*_filter)(frame)) {
+				continue;
+			}
+			_ts = rec.ts();
+			decode_ethernet(frame);
 		}
 	} catch (std::out_of_range&) {
 		/** No action. */
 	}
 }
 
+/** Export both directions of a connection using IPFIX.
+ * @param ex the exporter
+ * @param key the canonical 5-tuple of the connection
+ * @param conn the connection information
+ */
+void export_connection(ipfix::exporter& ex, const inet::five_tuple& key,
+	const inet::connection_info& conn) {
+
+	for (bool reverse : {false, true}) {
+		const inet::flow_info& info = conn.flow(reverse);
+		if (!info.empty()) {
+			ex.add((reverse) ? key.reverse() : key, info);
+		}
+	}
+}
+
+/** Make an IPFIX exporter for a given target.
+ * The target is either the pathname of a file to be written, "-" for
+ * standard output, or a URL of the form udp://host:port. IPv6 addresses
+ * in a URL must be enclosed in square brackets.
+ * @param target the target to which the flows should be exported
+ * @param file a file stream to be opened if the target is a file
+ * @return the exporter
+ */
+std::unique_ptr<ipfix::exporter> make_exporter(const std::string& target,
+	std::ofstream& file) {
+
+	const std::string udp_prefix = "udp://";
+	if (target.starts_with(udp_prefix)) {
+		std::string hostport = target.substr(udp_prefix.length());
+		size_t colon = hostport.rfind(':');
+		if (colon == std::string::npos) {
+			throw std::invalid_argument("port number not specified in IPFIX target");
+		}
+		std::string host = hostport.substr(0, colon);
+		std::string port = hostport.substr(colon + 1);
+		if (host.length() >= 2 && host.front() == '[' && host.back() == ']') {
+			host = host.substr(1, host.length() - 2);
+		}
+		return std::make_unique<ipfix::udp_exporter>(host, port);
+	} else if (target == "-") {
+		return std::make_unique<ipfix::stream_exporter>(std::cout);
+	} else {
+		file.open(target, std::ios::binary);
+		if (!file) {
+			throw std::runtime_error("failed to open IPFIX output file");
+		}
+		return std::make_unique<ipfix::stream_exporter>(file);
+	}
+}
+
+/** Parse a memory budget.
+ * The budget must be a positive whole number of mebibytes which can be
+ * expressed in octets as a size_t.
+ * @param arg the budget, in MiB
+ * @return the budget, in octets
+ */
+size_t parse_budget(const std::string& arg) {
+	size_t mib = 0;
+	const char* first = arg.data();
+	const char* last = first + arg.length();
+	auto [ptr, ec] = std::from_chars(first, last, mib);
+	if (ec != std::errc() || ptr != last || mib == 0 ||
+		mib > (SIZE_MAX >> 20)) {
+
+		throw std::invalid_argument("invalid memory budget");
+	}
+	return mib << 20;
+}
+
 int main(int argc, char* argv[]) {
 	bool join = false;
+	bool binary = false;
+	std::optional<std::string> ipfix_target;
+	std::optional<size_t> budget;
+	std::optional<net::filter> filter;
 
 	int opt;
-	while ((opt = getopt(argc, argv, "j")) != -1) {
+	while ((opt = getopt(argc, argv, "BF:I:M:j")) != -1) {
 		switch (opt) {
+		case 'B':
+			binary = true;
+			break;
+		case 'F':
+			try {
+				filter.emplace(optarg);
+			} catch (std::exception& ex) {
+				std::cerr << ex.what() << std::endl;
+				exit(1);
+			}
+			break;
+		case 'I':
+			ipfix_target = optarg;
+			break;
 		case 'j':
 			join = true;
 			break;
+		case 'M':
+			try {
+				budget = parse_budget(optarg);
+			} catch (std::exception& ex) {
+				std::cerr << ex.what() << std::endl;
+				exit(1);
+			}
+			break;
 		}
 	}
 
+	if (int(binary) + int(bool(ipfix_target)) + int(join) > 1) {
+		std::cerr << "options -B, -I and -j are mutually exclusive" <<
+			std::endl;
+		exit(1);
+	}
+
 	if (optind == argc) {
 		std::cerr << "PCAP file pathname not specified" << std::endl;
 		exit(1);
 	}
 
 	try {
-		flow_table_decoder decoder;
+		// Unless a binary flow-record file or a memory budget is
+		// required, connections are exported or summarised as they
+		// are finalised, so that they can be evicted from the flow
+		// table once closed.
+		std::ofstream ipfix_file;
+		std::unique_ptr<ipfix::exporter> exporter;
+		if (ipfix_target) {
+			exporter = make_exporter(*ipfix_target, ipfix_file);
+		}
+		std::map<inet::five_tuple, inet::flow_info> summary;
+		inet::flow_table::finalise_handler finalise;
+		if (exporter && !budget) {
+			finalise = [&exporter](const inet::five_tuple& key,
+				const inet::connection_info& conn) {
+				export_connection(*exporter, key, conn);
+			};
+		} else if (!binary && !budget) {
+			finalise = [&summary](const inet::five_tuple& key,
+				const inet::connection_info& conn) {
+				inet::flow_table::summarise(key, conn, summary);
+			};
+		}
+
+		flow_table_decoder decoder(filter, (budget) ?
+			inet::flow_table(*budget) : inet::flow_table(finalise));
 		while (optind != argc) {
 			std::string pathname = argv[optind++];
 			decoder.decode(pathname);
 		}
-		auto summary = decoder.flows().summarise();
+		if (finalise) {
+			decoder.finalise();
+		} else if (exporter) {
+			decoder.flows().for_each([&exporter](
+				const inet::five_tuple& key, const inet::flow_info& info) {
+				exporter->add(key, info);
+			});
+		} else if (binary) {
+			decoder.flows().write(std::cout);
+			return 0;
+		} else {
+			summary = decoder.flows().summarise();
+		}
+		if (exporter) {
+			exporter->flush();
+			return 0;
+		}
 
 		if (join) {
 			std::cout << '[';
@@ -102,7 +289,13 @@ int main(int argc, char* argv[]) {
 				}
 				std::cout << std::endl;
 			}
-			std::cout << i.to_bson().to_json();
+			bson::document bson_flow = i.first.to_bson();
+			bson_flow.append("packets", bson::int64(i.second.packets()));
+			bson_flow.append("octets", bson::int64(i.second.octets()));
+			bson_flow.append("first", bson::int64(i.second.first()));
+			bson_flow.append("last", bson::int64(i.second.last()));
+			bson_flow.append("tcp_flags", bson::int32(i.second.tcp_flags()));
+			std::cout << bson_flow.to_json();
 		}
 
 		if (join) {
@@ -0,0 +1,339 @@
+// This file is part of libholmes.
+// Copyright 2023 Graham Shaw.
+// Distribution and modification are permitted within the terms of the
+// GNU General Public License (version 3 or any later version).
+
+#include <charconv>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include <getopt.h>
+
+#include "holmes/bson/int64.h"
+#include "holmes/bson/string.h"
+#include "holmes/bson/binary.h"
+#include "holmes/bson/boolean.h"
+#include "holmes/bson/document.h"
+#include "holmes/octet/file.h"
+#include "holmes/octet/stream/listener.h"
+#include "holmes/pcap/file.h"
+#include "holmes/net/inet/datagram.h"
+#include "holmes/net/inet/five_tuple.h"
+#include "holmes/net/tcp/segment.h"
+#include "holmes/net/tcp/event.h"
+#include "holmes/net/tcp/reassembler.h"
+#include "holmes/net/tcp/policy_linux_2_2.h"
+#include "holmes/net/tcp/policy_linux_2_4.h"
+#include "holmes/net/tcp/prefer_old_content.h"
+#include "holmes/net/filter.h"
+#include "holmes/net/decoder.h"
+
+using namespace holmes;
+using namespace holmes::net;
+
+void write_help(std::ostream& out) {
+	out << "Usage: holmes-reassemble <pathname> ..." << std::endl;
+	out << std::endl;
+	out << "Reassemble the TCP connections in a capture, writing one JSON" << std::endl;
+	out << "document for each run of content delivered and each gap skipped." << std::endl;
+	out << std::endl;
+	out << "Options:" << std::endl;
+	out << std::endl;
+	out << "  -F  ingest only packets which match a filter expression" << std::endl;
+	out << "  -j  join output into single JSON array" << std::endl;
+	out << "  -L  limit the content buffered per connection, in octets" << std::endl;
+	out << "  -M  limit the content buffered by all connections, in octets" << std::endl;
+	out << "  -P  select the reassembly policy for overlapping content:" << std::endl;
+	out << "      linux-2.2, linux-2.4 (the default) or prefer-old" << std::endl;
+}
+
+/** A class for writing the events of reassembled streams as JSON. */
+class json_output {
+private:
+	/** True if the output is to be joined into a single JSON array. */
+	bool _join;
+
+	/** True if no document has yet been written. */
+	bool _first = true;
+public:
+	/** Construct JSON output.
+	 * @param join true to join the output into a single JSON array
+	 */
+	explicit json_output(bool join):
+		_join(join) {}
+
+	/** Write a document.
+	 * @param doc the document to be written
+	 */
+	void write(const bson::document& doc);
+
+	/** Finish writing. */
+	void close();
+};
+
+void json_output::write(const bson::document& doc) {
+	if (_first) {
+		if (_join) {
+			std::cout << '[';
+		}
+		_first = false;
+	} else if (_join) {
+		std::cout << ',';
+	}
+	std::cout << doc.to_json();
+	if (!_join) {
+		std::cout << std::endl;
+	}
+}
+
+void json_output::close() {
+	if (_join) {
+		if (_first) {
+			std::cout << '[';
+		}
+		std::cout << ']' << std::endl;
+	}
+}
+
+/** A listener class for writing the events of one TCP connection. */
+class connection_listener final:
+	public octet::stream::listener {
+private:
+	/** The connection, as a string. */
+	std::string _connection;
+
+	/** The output to which events are written. */
+	json_output* _out;
+public:
+	/** Construct connection listener.
+	 * @param key the canonical 5-tuple of the connection
+	 * @param out the output to which events should be written
+	 */
+	connection_listener(const inet::five_tuple& key, json_output& out):
+		_connection(key),
+		_out(&out) {}
+
+	void handle(const octet::stream::event& ev) override;
+};
+
+void connection_listener::handle(const octet::stream::event& ev) {
+	auto& tcp_ev = dynamic_cast<const tcp::event&>(ev);
+	bson::document doc;
+	doc.append("connection", bson::string(_connection));
+	doc.append("direction", bson::string(
+		(tcp_ev.direction()) ? "to_server" : "to_client"));
+	doc.append("from_seq", bson::int64(tcp_ev.from_seq()));
+	doc.append("to_seq", bson::int64(tcp_ev.to_seq()));
+	if (tcp_ev.segment()) {
+		doc.append("payload", bson::binary(tcp_ev.payload()));
+	} else {
+		doc.append("missing", bson::boolean(true));
+	}
+	_out->write(doc);
+}
+
+/** A structure to hold the reassembly state of one TCP connection. */
+struct connection {
+	/** The listener to which events are delivered. */
+	connection_listener listener;
+
+	/** The reassembler for the connection. */
+	tcp::reassembler reassembler;
+
+	/** Construct connection.
+	 * @param key the canonical 5-tuple of the connection
+	 * @param out the output to which events should be written
+	 * @param policy the reassembly policy
+	 * @param flow_limit the maximum content to be buffered, in octets
+	 * @param budget a budget shared with other connections, or null
+	 */
+	connection(const inet::five_tuple& key, json_output& out,
+		tcp::reassembly_policy& policy, size_t flow_limit,
+		tcp::reassembly_budget* budget):
+		listener(key, out),
+		reassembler(policy, listener, flow_limit, budget) {}
+};
+
+class reassembling_decoder final:
+	public net::decoder {
+private:
+	/** The output to which events are written. */
+	json_output* _out;
+
+	/** The reassembly policy. */
+	tcp::reassembly_policy* _policy;
+
+	/** The maximum content to be buffered per connection, in octets. */
+	size_t _flow_limit;
+
+	/** The budget shared between connections, or null if none. */
+	tcp::reassembly_budget* _budget;
+
+	/** An optional filter for selecting which packets to ingest. */
+	std::optional<net::filter> _filter;
+
+	/** The connections, keyed by canonical 5-tuple. */
+	std::map<inet::five_tuple, std::unique_ptr<connection>> _connections;
+protected:
+	void handle_tcp(const inet::datagram& inet_dgram,
+		const tcp::segment& tcp_seg) override;
+public:
+	/** Construct reassembling decoder.
+	 * @param out the output to which events should be written
+	 * @param policy the reassembly policy
+	 * @param flow_limit the maximum content to be buffered per
+	 *  connection, in octets
+	 * @param budget a budget shared between connections, or null
+	 * @param filter an optional filter for selecting packets
+	 */
+	reassembling_decoder(json_output& out, tcp::reassembly_policy& policy,
+		size_t flow_limit, tcp::reassembly_budget* budget,
+		const std::optional<net::filter>& filter):
+		_out(&out),
+		_policy(&policy),
+		_flow_limit(flow_limit),
+		_budget(budget),
+		_filter(filter) {}
+
+	void decode(const std::string& pathname);
+
+	/** Deliver all content remaining in each connection. */
+	void flush();
+};
+
+void reassembling_decoder::handle_tcp(const inet::datagram& inet_dgram,
+	const tcp::segment& tcp_seg) {
+
+	inet::five_tuple key(inet_dgram, tcp_seg);
+	if (!key.canonical()) {
+		key = key.reverse();
+	}
+	auto& conn = _connections[key];
+	if (!conn) {
+		conn = std::make_unique<connection>(key, *_out, *_policy,
+			_flow_limit, _budget);
+	}
+	conn->reassembler.ingest(inet_dgram, tcp_seg);
+}
+
+void reassembling_decoder::decode(const std::string& pathname) {
+	try {
+		octet::file file(pathname);
+		pcap::file pf(file);
+
+		while (true) {
+			pcap::record rec = pf.read();
+			octet::string frame = rec.payload();
+			if (_filter && !(*_filter)(frame)) {
+				continue;
+			}
+			decode_ethernet(frame);
+		}
+	} catch (std::out_of_range&) {
+		/** No action. */
+	}
+}
+
+void reassembling_decoder::flush() {
+	for (auto& [key, conn] : _connections) {
+		conn->reassembler.flush();
+	}
+}
+
+/** Parse a limit on buffered content.
+ * @param arg the limit, in octets
+ * @return the limit, in octets
+ */
+size_t parse_limit(const std::string& arg) {
+	size_t limit = 0;
+	const char* first = arg.data();
+	const char* last = first + arg.length();
+	auto [ptr, ec] = std::from_chars(first, last, limit);
+	if (ec != std::errc() || ptr != last) {
+		throw std::invalid_argument("invalid buffer limit");
+	}
+	return limit;
+}
+
+/** Make a reassembly policy.
+ * @param name the name of the policy
+ * @return the policy
+ */
+std::unique_ptr<tcp::reassembly_policy> make_policy(const std::string& name) {
+	if (name == "linux-2.2") {
+		return std::make_unique<tcp::policy_linux_2_2>();
+	} else if (name == "linux-2.4") {
+		return std::make_unique<tcp::policy_linux_2_4>();
+	} else if (name == "prefer-old") {
+		return std::make_unique<tcp::prefer_old_content>();
+	} else {
+		throw std::invalid_argument("unrecognised reassembly policy");
+	}
+}
+
+int main(int argc, char* argv[]) {
+	bool join = false;
+	size_t flow_limit = tcp::reassembler::default_flow_limit;
+	std::optional<tcp::reassembly_budget> budget;
+	std::unique_ptr<tcp::reassembly_policy> policy;
+	std::optional<net::filter> filter;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "F:hjL:M:P:")) != -1) {
+		try {
+			switch (opt) {
+			case 'F':
+				filter.emplace(optarg);
+				break;
+			case 'h':
+				write_help(std::cout);
+				return 0;
+			case 'j':
+				join = true;
+				break;
+			case 'L':
+				flow_limit = parse_limit(optarg);
+				break;
+			case 'M':
+				budget.emplace(parse_limit(optarg));
+				break;
+			case 'P':
+				policy = make_policy(optarg);
+				break;
+			}
+		} catch (std::exception& ex) {
+			std::cerr << ex.what() << std::endl;
+			exit(1);
+		}
+	}
+	if (!policy) {
+		policy = make_policy("linux-2.4");
+	}
+
+	if (optind == argc) {
+		std::cerr << "PCAP file pathname not specified" << std::endl;
+		exit(1);
+	}
+
+	json_output out(join);
+	try {
+		reassembling_decoder decoder(out, *policy, flow_limit,
+			(budget) ? &*budget : nullptr, filter);
+		while (optind != argc) {
+			std::string pathname = argv[optind++];
+			decoder.decode(pathname);
+		}
+		decoder.flush();
+	} catch (std::exception& ex) {
+		std::cout.flush();
+		std::cerr << ex.what() << std::endl;
+		exit(1);
+	}
+	out.close();
+	return 0;
+}
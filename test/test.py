@@ -3,6 +3,9 @@
 import sys
 import subprocess
 import json
+import base64
+import struct
+import tempfile
 
 # Each test must include a 'data' member containing the data to be decoded,
 # and an 'expected' member containing the expected result.
@@ -10,23 +13,92 @@ import json
 # All listed members and submembers of the expected result must be present
 # in the observed result and must match. The observed result may contain
 # additional members which are not listed. Order is not significant.
+#
+# If the test includes an 'exact' member which is true then the observed
+# result must not contain any members or list elements other than those
+# listed, so that a test can assert that something has been omitted.
+#
+# A test may optionally include an 'args' member containing a list of
+# additional arguments to be passed to the decoder. If the decoder produces
+# no output (for example, because the data was rejected by a filter) then
+# the observed result is null.
+#
+# In place of 'data', a test may include a 'pcapdata' member containing a
+# base64-encoded PCAP file, which is passed to the decoder by pathname.
+# If the decoder is asked for Arrow output (with -A) then the observed
+# result is a summary of the IPC stream: the total number of 'rows' in
+# its record batches, and whether it finished with an 'end_of_stream'
+# marker.
+#
+# A test may include a 'subcommand' member naming the holmes command to
+# be run in place of 'decode' (for example "reassemble"). This is useful
+# only with 'pcapdata', since the other forms of data are passed using
+# options specific to holmes-decode.
+#
+# A test may include a 'via' member containing a holmes command and its
+# arguments (for example ["bson"]). The output of the decoder is then
+# written to a temporary file, which is passed to that command by
+# pathname, and the observed result is taken from its output instead.
 
-def compare(path, expected, observed):
+def flatbuffer_field(buf, table, index):
+    """Get the offset of a field within a flatbuffer table, or None."""
+    vtable = table - struct.unpack_from('<i', buf, table)[0]
+    vtable_length = struct.unpack_from('<H', buf, vtable)[0]
+    if 4 + index * 2 >= vtable_length:
+        return None
+    offset = struct.unpack_from('<H', buf, vtable + 4 + index * 2)[0]
+    return table + offset if offset else None
+
+def summarise_arrow(stream):
+    """Summarise an Arrow IPC stream."""
+    rows = 0
+    pos = 0
+    while pos + 8 <= len(stream):
+        marker, length = struct.unpack_from('<Ii', stream, pos)
+        if marker != 0xffffffff:
+            break
+        pos += 8
+        if length == 0:
+            return {'rows': rows, 'end_of_stream': pos == len(stream)}
+        message = stream[pos:pos + length]
+        pos += length
+        root = struct.unpack_from('<I', message, 0)[0]
+        header_type = flatbuffer_field(message, root, 1)
+        body_length = flatbuffer_field(message, root, 3)
+        if header_type is not None and message[header_type] == 3:
+            header = flatbuffer_field(message, root, 2)
+            header += struct.unpack_from('<I', message, header)[0]
+            batch_length = flatbuffer_field(message, header, 0)
+            if batch_length is not None:
+                rows += struct.unpack_from('<q', message, batch_length)[0]
+        if body_length is not None:
+            pos += struct.unpack_from('<q', message, body_length)[0]
+    return {'rows': rows, 'end_of_stream': False}
+
+def compare(path, expected, observed, exact=False):
     if isinstance(expected, dict):
         if not isinstance(observed, dict):
-            raise AssertionError('%s not an object in result' % subpath)
+            raise AssertionError('%s not an object in result' % path)
         for key in expected:
             subpath = '.'.join([path, key]) if path else key
             if key in observed:
-                compare(subpath, expected[key], observed[key])
+                compare(subpath, expected[key], observed[key], exact)
             else:
                 raise AssertionError('missing %s from result' % subpath)
+        if exact:
+            for key in observed:
+                if key not in expected:
+                    subpath = '.'.join([path, key]) if path else key
+                    raise AssertionError('unexpected %s in result' % subpath)
     elif isinstance(expected, list):
         if not isinstance(observed, list):
-            raise AssertionError('%s not a list in result' % subpath)
+            raise AssertionError('%s not a list in result' % path)
+        if exact and len(observed) != len(expected):
+            raise AssertionError('length mismatch at %s: expected %d, found %d'
+                % (path, len(expected), len(observed)))
         for index in range(0, len(expected)):
             subpath = '.'.join([path, str(index)]) if path else str(index)
-            compare(subpath, expected[index], observed[index])
+            compare(subpath, expected[index], observed[index], exact)
     elif observed != expected:
         raise AssertionError('mismatch at %s: expected <%s>, found <%s>' %
             (path, expected, observed))
@@ -34,19 +106,34 @@ def compare(path, expected, observed):
 def test(pathname):
     file = open(pathname, "r")
     test = json.load(file)
+    expected = test["expected"]
+    args = test.get("args", [])
+    pcap = None
     if "data" in test:
-        data = test["data"]
-        encoding = "-b"
+        args = args + ["-b", test["data"]]
     elif "hexdata" in test:
-        data = test["hexdata"]
-        encoding = "-x"
+        args = args + ["-x", test["hexdata"]]
+    elif "pcapdata" in test:
+        pcap = tempfile.NamedTemporaryFile(suffix='.pcap')
+        pcap.write(base64.b64decode(test["pcapdata"]))
+        pcap.flush()
+        args = args + [pcap.name]
     else:
-        raise KeyError("data/hexdata")
-    expected = test["expected"]
+        raise KeyError("data/hexdata/pcapdata")
 
-    sp = subprocess.run(['holmes', 'decode', encoding, data], stdout=subprocess.PIPE)
-    observed = json.loads(sp.stdout)
-    compare('', expected, observed)
+    subcommand = test.get("subcommand", "decode")
+    sp = subprocess.run(['holmes', subcommand] + args, stdout=subprocess.PIPE)
+    if "via" in test:
+        output = tempfile.NamedTemporaryFile()
+        output.write(sp.stdout)
+        output.flush()
+        args = test["via"] + [output.name]
+        sp = subprocess.run(['holmes'] + args, stdout=subprocess.PIPE)
+    if "-A" in args:
+        observed = summarise_arrow(sp.stdout)
+    else:
+        observed = json.loads(sp.stdout) if sp.stdout.strip() else None
+    compare('', expected, observed, test.get("exact", False))
 
 try:
     for pathname in sys.argv[1:]: